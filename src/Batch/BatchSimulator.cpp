@@ -0,0 +1,170 @@
+#include "BatchSimulator.hpp"
+#include "../Server/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+
+void Jetpack::Batch::BatchStats::merge(const BatchStats &other) {
+  matches += other.matches;
+  steps += other.steps;
+  capped += other.capped;
+  slots.resize(std::max(slots.size(), other.slots.size()));
+  for (size_t i = 0; i < other.slots.size(); i++) {
+    slots[i].wins += other.slots[i].wins;
+    slots[i].coins += other.slots[i].coins;
+    slots[i].deaths += other.slots[i].deaths;
+    slots[i].finishes += other.slots[i].finishes;
+  }
+  for (const auto &[column, count] : other.deathColumns) {
+    deathColumns[column] += count;
+  }
+}
+
+void Jetpack::Batch::BatchStats::print(
+    std::ostream &output, const std::vector<std::string> &policies) const {
+  const double playSeconds =
+      steps *
+      std::chrono::duration<double>(Server::Match::TICK_PERIOD).count();
+  const double perMatch = matches > 0 ? 1.0 / matches : 0.0;
+
+  output << std::fixed << std::setprecision(2) << matches << " matches in "
+         << seconds << " s (" << (seconds > 0.0 ? matches / seconds : 0.0)
+         << " matches/s, "
+         << (seconds > 0.0 ? playSeconds / seconds : 0.0) << "x real time)\n"
+         << "average length " << steps * perMatch << " steps, " << capped
+         << " stopped at the step limit\n\n";
+
+  output << std::left << std::setw(6) << "slot" << std::setw(20) << "policy"
+         << std::right << std::setw(8) << "win %" << std::setw(14)
+         << "coins/match" << std::setw(10) << "death %" << std::setw(12)
+         << "finish %" << "\n";
+  for (size_t i = 0; i < slots.size(); i++) {
+    output << std::left << std::setw(6) << i + 1 << std::setw(20)
+           << policies[i] << std::right << std::setw(8)
+           << 100.0 * slots[i].wins * perMatch << std::setw(14)
+           << slots[i].coins * perMatch << std::setw(10)
+           << 100.0 * slots[i].deaths * perMatch << std::setw(12)
+           << 100.0 * slots[i].finishes * perMatch << "\n";
+  }
+
+  uint64_t totalDeaths = 0;
+  std::vector<std::pair<int, uint64_t>> columns(deathColumns.begin(),
+                                                deathColumns.end());
+  for (const auto &[_, count] : columns) {
+    totalDeaths += count;
+  }
+  if (totalDeaths == 0) {
+    return;
+  }
+
+  std::sort(columns.begin(), columns.end(), [](const auto &a, const auto &b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  columns.resize(std::min(columns.size(), TOP_DEATH_COLUMNS));
+
+  output << "\ndeadliest columns (" << totalDeaths << " deaths)\n";
+  for (const auto &[column, count] : columns) {
+    output << "  x=" << std::setw(4) << column << std::setw(8) << count
+           << std::setw(8) << 100.0 * count / totalDeaths << " %\n";
+  }
+}
+
+Jetpack::Batch::BatchSimulator::BatchSimulator(
+    const Server::MapTemplate &mapTemplate, const BatchConfig &config)
+    : m_mapTemplate(mapTemplate), m_config(config) {
+  m_serverConfig.playersPerMatch = config.policies.size();
+}
+
+Jetpack::Batch::BatchStats Jetpack::Batch::BatchSimulator::run() {
+  const auto start = std::chrono::steady_clock::now();
+  const size_t threads = std::max<size_t>(m_config.threads, 1);
+
+  std::vector<BatchStats> workerStats(threads);
+  std::atomic<size_t> nextMatch{0};
+  Server::ThreadPool pool(threads);
+
+  pool.parallelFor(threads, [&](size_t worker) {
+    Server::MatchServices services;
+    services.offline = true;
+    Server::MatchRunner runner(m_serverConfig, services);
+
+    size_t index;
+    while ((index = nextMatch.fetch_add(1, std::memory_order_relaxed)) <
+           m_config.matches) {
+      runMatch(runner, index, workerStats[worker]);
+    }
+  });
+
+  BatchStats stats;
+  stats.slots.resize(m_config.policies.size());
+  for (const BatchStats &worker : workerStats) {
+    stats.merge(worker);
+  }
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  return stats;
+}
+
+void Jetpack::Batch::BatchSimulator::runMatch(Server::MatchRunner &runner,
+                                              size_t index,
+                                              BatchStats &stats) const {
+  const size_t slots = m_config.policies.size();
+  std::vector<std::unique_ptr<InputPolicy>> policies;
+  for (size_t slot = 0; slot < slots; slot++) {
+    policies.push_back(InputPolicy::create(
+        m_config.policies[slot], m_config.seed + index * slots + slot));
+  }
+
+  // Headless players use negative keys; slot i joins as player id i + 1.
+  Server::Match *match = runner.createMatch(m_mapTemplate);
+  for (size_t slot = 0; slot < slots; slot++) {
+    match->addPlayer(-1 - static_cast<int>(slot));
+  }
+  match->checkGameStart();
+
+  bool finished = false;
+  while (!finished) {
+    for (size_t slot = 0; slot < slots; slot++) {
+      const int key = -1 - static_cast<int>(slot);
+      auto it = match->getPlayers().find(key);
+      if (it != match->getPlayers().end()) {
+        match->setPlayerInput(key, policies[slot]->decide(it->second, *match),
+                              0);
+      }
+    }
+
+    if (match->getStep() >= m_config.maxSteps) {
+      match->forceEnd();
+      stats.capped++;
+    }
+    runner.tick([&](const Server::Match &over) {
+      collect(over, stats);
+      finished = true;
+    });
+  }
+}
+
+void Jetpack::Batch::BatchSimulator::collect(const Server::Match &match,
+                                             BatchStats &stats) const {
+  stats.slots.resize(m_config.policies.size());
+  stats.matches++;
+  stats.steps += match.getStep();
+
+  for (const auto &[_, player] : match.getPlayers()) {
+    SlotStats &slot = stats.slots[player.getId() - 1];
+    slot.coins += player.getScore();
+    if (player.getId() == match.getWinnerId()) {
+      slot.wins++;
+    }
+    if (player.getState() == Shared::Protocol::PlayerState::DEAD) {
+      slot.deaths++;
+      stats.deathColumns[static_cast<int>(player.getPosition().x)]++;
+    } else if (player.getState() ==
+               Shared::Protocol::PlayerState::FINISHED) {
+      slot.finishes++;
+    }
+  }
+}
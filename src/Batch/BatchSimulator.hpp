@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../Server/Match.hpp"
+#include "../Server/MatchRunner.hpp"
+#include "InputPolicy.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Jetpack::Batch {
+struct BatchConfig {
+  std::vector<std::string> policies;
+  size_t matches = 1000;
+  size_t threads = 1;
+  uint32_t seed = 1;
+  uint32_t maxSteps = 100000;
+};
+
+struct SlotStats {
+  uint64_t wins = 0;
+  uint64_t coins = 0;
+  uint64_t deaths = 0;
+  uint64_t finishes = 0;
+};
+
+struct BatchStats {
+  static constexpr size_t TOP_DEATH_COLUMNS = 10;
+
+  uint64_t matches = 0;
+  uint64_t steps = 0;
+  uint64_t capped = 0;
+  std::vector<SlotStats> slots;
+  std::map<int, uint64_t> deathColumns;
+  double seconds = 0.0;
+
+  void merge(const BatchStats &other);
+  void print(std::ostream &output,
+             const std::vector<std::string> &policies) const;
+};
+
+// Plays matches back to back on a virtual clock: every player is driven by
+// an input policy, nothing is sent, and a step is taken as soon as the
+// previous one is done. Workers each run their own matches; match i always
+// uses the same seeds, so results do not depend on the thread count.
+class BatchSimulator {
+public:
+  BatchSimulator(const Server::MapTemplate &mapTemplate,
+                 const BatchConfig &config);
+
+  BatchStats run();
+
+private:
+  void runMatch(Server::MatchRunner &runner, size_t index,
+                BatchStats &stats) const;
+  void collect(const Server::Match &match, BatchStats &stats) const;
+
+  const Server::MapTemplate &m_mapTemplate;
+  BatchConfig m_config;
+  Server::ServerConfig m_serverConfig;
+};
+} // namespace Jetpack::Batch
@@ -0,0 +1,131 @@
+#include "InputPolicy.hpp"
+#include "../Shared/Exceptions.hpp"
+#include <cmath>
+#include <cstdlib>
+
+std::unique_ptr<Jetpack::Batch::InputPolicy>
+Jetpack::Batch::InputPolicy::create(const std::string &spec, uint32_t seed) {
+  const size_t colon = spec.find(':');
+  const std::string name = spec.substr(0, colon);
+  const std::string argument =
+      colon == std::string::npos ? "" : spec.substr(colon + 1);
+
+  try {
+    if (name == "idle" && argument.empty()) {
+      return std::make_unique<IdlePolicy>();
+    }
+    if (name == "random") {
+      return std::make_unique<RandomPolicy>(
+          seed, argument.empty() ? 5.0 : std::stod(argument));
+    }
+    if (name == "pulse" && argument.find('/') != std::string::npos) {
+      const size_t slash = argument.find('/');
+      return std::make_unique<PulsePolicy>(
+          std::stoul(argument.substr(0, slash)),
+          std::stoul(argument.substr(slash + 1)));
+    }
+    if (name == "hover") {
+      return std::make_unique<HoverPolicy>(
+          argument.empty() ? -1 : std::stoi(argument));
+    }
+    if (name == "greedy" && argument.empty()) {
+      return std::make_unique<GreedyPolicy>();
+    }
+  } catch (const std::logic_error &) {
+  }
+  throw Jetpack::Shared::Exceptions::BatchException("Invalid policy " + spec);
+}
+
+bool Jetpack::Batch::RandomPolicy::decide(const Shared::Protocol::Player &,
+                                          const Server::Match &) {
+  if (m_toggle(m_random)) {
+    m_jetpacking = !m_jetpacking;
+  }
+  return m_jetpacking;
+}
+
+bool Jetpack::Batch::PulsePolicy::decide(const Shared::Protocol::Player &,
+                                         const Server::Match &) {
+  const uint32_t period = m_onSteps + m_offSteps;
+  const bool on = period > 0 && m_step % period < m_onSteps;
+  m_step++;
+  return on;
+}
+
+bool Jetpack::Batch::HoverPolicy::steerTowards(
+    const Shared::Protocol::Player &player, float row) {
+  const float predicted =
+      player.getPosition().y + player.getVelocityY() * PREDICTION_STEPS;
+  return predicted > row;
+}
+
+bool Jetpack::Batch::HoverPolicy::decide(const Shared::Protocol::Player &player,
+                                         const Server::Match &match) {
+  const int height = match.getMap().height;
+  return steerTowards(player, m_row < 0 ? height / 2.0f
+                                        : std::min(m_row, height - 1));
+}
+
+bool Jetpack::Batch::GreedyPolicy::isDangerous(const Server::Match &match,
+                                               int row, int fromX) {
+  const Shared::Protocol::GameMap &map = match.getMap();
+  const int toX = std::min(map.width, fromX + DANGER_COLUMNS + 1);
+  for (int x = std::max(fromX, 0); x < toX; x++) {
+    if (map.tiles[row][x] == Shared::Protocol::TileType::ELECTRICSQUARE) {
+      return true;
+    }
+  }
+
+  const Server::EntityStore &entities = match.getEntities();
+  for (size_t id = 0; id < entities.size(); id++) {
+    if (!entities.isAlive(id)) {
+      continue;
+    }
+    for (int x = fromX; x < toX; x++) {
+      if (entities.isLethalAt(id, x + 0.5f, row + 0.5f)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool Jetpack::Batch::GreedyPolicy::decide(
+    const Shared::Protocol::Player &player, const Server::Match &match) {
+  const Shared::Protocol::GameMap &map = match.getMap();
+  const int x = static_cast<int>(player.getPosition().x);
+  const int y = static_cast<int>(player.getPosition().y);
+
+  int targetRow = y;
+  int bestDistance = -1;
+  const int toX = std::min(map.width, x + LOOKAHEAD_COLUMNS + 1);
+  for (int column = x + 1; column < toX; column++) {
+    for (int row = 0; row < map.height; row++) {
+      if (map.tiles[row][column] != Shared::Protocol::TileType::COIN ||
+          isDangerous(match, row, x)) {
+        continue;
+      }
+      const int distance = (column - x) + std::abs(row - y);
+      if (bestDistance < 0 || distance < bestDistance) {
+        bestDistance = distance;
+        targetRow = row;
+      }
+    }
+  }
+
+  // Without a coin to chase, move to the closest safe row.
+  if (bestDistance < 0 && isDangerous(match, targetRow, x)) {
+    for (int offset = 1; offset < map.height; offset++) {
+      if (y - offset >= 0 && !isDangerous(match, y - offset, x)) {
+        targetRow = y - offset;
+        break;
+      }
+      if (y + offset < map.height && !isDangerous(match, y + offset, x)) {
+        targetRow = y + offset;
+        break;
+      }
+    }
+  }
+
+  return HoverPolicy::steerTowards(player, static_cast<float>(targetRow));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../Server/Match.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace Jetpack::Batch {
+// Decides on every simulation step whether a player holds the jetpack.
+class InputPolicy {
+public:
+  virtual ~InputPolicy() = default;
+
+  virtual bool decide(const Shared::Protocol::Player &player,
+                      const Server::Match &match) = 0;
+
+  // spec is idle, random[:percent], pulse:<on>/<off>, hover[:row] or greedy.
+  static std::unique_ptr<InputPolicy> create(const std::string &spec,
+                                             uint32_t seed);
+};
+
+class IdlePolicy : public InputPolicy {
+public:
+  bool decide(const Shared::Protocol::Player &,
+              const Server::Match &) override {
+    return false;
+  }
+};
+
+// Flips the input with a fixed probability per step.
+class RandomPolicy : public InputPolicy {
+public:
+  RandomPolicy(uint32_t seed, double togglePercent)
+      : m_random(seed), m_toggle(togglePercent / 100.0) {}
+
+  bool decide(const Shared::Protocol::Player &player,
+              const Server::Match &match) override;
+
+private:
+  std::mt19937 m_random;
+  std::bernoulli_distribution m_toggle;
+  bool m_jetpacking = false;
+};
+
+// Holds the jetpack for a number of steps, then releases it, repeatedly.
+class PulsePolicy : public InputPolicy {
+public:
+  PulsePolicy(uint32_t onSteps, uint32_t offSteps)
+      : m_onSteps(onSteps), m_offSteps(offSteps) {}
+
+  bool decide(const Shared::Protocol::Player &player,
+              const Server::Match &match) override;
+
+private:
+  uint32_t m_onSteps;
+  uint32_t m_offSteps;
+  uint32_t m_step = 0;
+};
+
+// Keeps the player near one row; a negative row means mid-height.
+class HoverPolicy : public InputPolicy {
+public:
+  explicit HoverPolicy(int row) : m_row(row) {}
+
+  bool decide(const Shared::Protocol::Player &player,
+              const Server::Match &match) override;
+
+  // Bang-bang control towards a row using the predicted position.
+  static bool steerTowards(const Shared::Protocol::Player &player, float row);
+
+private:
+  static constexpr float PREDICTION_STEPS = 8.0f;
+
+  int m_row;
+};
+
+// Steers towards the nearest coin ahead while keeping clear of rows with
+// electric squares or live entities in the next few columns.
+class GreedyPolicy : public InputPolicy {
+public:
+  bool decide(const Shared::Protocol::Player &player,
+              const Server::Match &match) override;
+
+private:
+  static constexpr int LOOKAHEAD_COLUMNS = 8;
+  static constexpr int DANGER_COLUMNS = 3;
+
+  static bool isDangerous(const Server::Match &match, int row, int fromX);
+};
+} // namespace Jetpack::Batch
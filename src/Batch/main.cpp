@@ -0,0 +1,87 @@
+#include "../Server/MapLoader.hpp"
+#include "../Shared/Exceptions.hpp"
+#include "BatchSimulator.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name
+            << " -m <map> -P <policy>,<policy>[,...] [-n <matches>]"
+               " [-t <threads>] [-S <seed>] [-l <step limit>]\n"
+               "Policies: idle, random[:toggle %], pulse:<on>/<off>,"
+               " hover[:row], greedy"
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  Jetpack::Batch::BatchConfig config;
+  config.threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string mapFile;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-m" && i + 1 < argc) {
+      mapFile = argv[++i];
+    } else if (arg == "-P" && i + 1 < argc) {
+      std::istringstream list(argv[++i]);
+      std::string policy;
+      while (std::getline(list, policy, ',')) {
+        config.policies.push_back(policy);
+      }
+    } else if (arg == "-n" && i + 1 < argc) {
+      config.matches = std::stoul(argv[++i]);
+    } else if (arg == "-t" && i + 1 < argc) {
+      config.threads = std::stoul(argv[++i]);
+    } else if (arg == "-S" && i + 1 < argc) {
+      config.seed = std::stoul(argv[++i]);
+    } else if (arg == "-l" && i + 1 < argc) {
+      config.maxSteps = std::stoul(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (mapFile.empty()) {
+    std::cerr << "Error: Map file is required" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+  if (config.policies.size() < 2 || config.policies.size() > 255) {
+    std::cerr << "Error: Between 2 and 255 policies are required, one per"
+                 " player"
+              << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+  if (config.threads == 0) {
+    std::cerr << "Error: Invalid thread count" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    for (const std::string &policy : config.policies) {
+      Jetpack::Batch::InputPolicy::create(policy, 0);
+    }
+
+    std::ifstream file(mapFile);
+    Jetpack::Server::MapTemplate mapTemplate;
+    if (!file.is_open() ||
+        !Jetpack::Server::MapLoader::load(file, mapTemplate)) {
+      throw Jetpack::Shared::Exceptions::MapLoaderException(
+          "Failed to load map file: " + mapFile);
+    }
+
+    Jetpack::Batch::BatchSimulator simulator(mapTemplate, config);
+    simulator.run().print(std::cout, config.policies);
+  } catch (const Jetpack::Shared::Exceptions::Exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
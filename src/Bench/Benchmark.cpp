@@ -0,0 +1,154 @@
+#include "Benchmark.hpp"
+#include "../Shared/Exceptions.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+void Jetpack::Bench::Runner::add(std::string name, Body body) {
+  m_benchmarks.push_back({std::move(name), std::move(body)});
+}
+
+double Jetpack::Bench::Runner::measure(const Body &body, uint64_t iterations) {
+  auto start = std::chrono::steady_clock::now();
+  body(iterations);
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+std::vector<Jetpack::Bench::Result>
+Jetpack::Bench::Runner::run(const std::string &filter) const {
+  std::vector<Result> results;
+
+  for (const auto &benchmark : m_benchmarks) {
+    if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+
+    uint64_t iterations = 1;
+    double elapsed = measure(benchmark.body, iterations);
+    while (elapsed < CALIBRATION_TARGET_NS) {
+      iterations *= 2;
+      elapsed = measure(benchmark.body, iterations);
+    }
+    iterations = std::max<uint64_t>(
+        1, static_cast<uint64_t>(iterations * SAMPLE_TARGET_NS / elapsed));
+
+    std::vector<double> samples;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+      samples.push_back(measure(benchmark.body, iterations) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    results.push_back({benchmark.name, samples[samples.size() / 2],
+                       samples.front(), iterations});
+    std::cerr << "  " << benchmark.name << std::endl;
+  }
+
+  return results;
+}
+
+void Jetpack::Bench::printResults(const std::vector<Result> &results) {
+  std::cout << std::left << std::setw(48) << "benchmark" << std::right
+            << std::setw(14) << "ns/op" << std::setw(14) << "min ns/op"
+            << std::setw(14) << "iterations" << std::endl;
+
+  std::cout << std::fixed << std::setprecision(1);
+  for (const auto &result : results) {
+    std::cout << std::left << std::setw(48) << result.name << std::right
+              << std::setw(14) << result.nsPerOp << std::setw(14)
+              << result.minNsPerOp << std::setw(14) << result.iterations
+              << std::endl;
+  }
+}
+
+void Jetpack::Bench::writeJson(const std::string &path,
+                               const std::vector<Result> &results) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    throw Shared::Exceptions::Exception("Failed to open " + path);
+  }
+
+  file << std::fixed << std::setprecision(3) << "{\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    file << "    {\"name\": \"" << results[i].name
+         << "\", \"ns_per_op\": " << results[i].nsPerOp
+         << ", \"min_ns_per_op\": " << results[i].minNsPerOp
+         << ", \"iterations\": " << results[i].iterations << "}"
+         << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n}\n";
+}
+
+// Reads files produced by writeJson(), which hold one benchmark per line.
+std::vector<Jetpack::Bench::Result>
+Jetpack::Bench::readJson(const std::string &path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw Shared::Exceptions::Exception("Failed to open " + path);
+  }
+
+  auto readNumber = [](const std::string &line, const std::string &key) {
+    size_t position = line.find("\"" + key + "\":");
+    if (position == std::string::npos) {
+      return 0.0;
+    }
+    return std::stod(line.substr(position + key.size() + 3));
+  };
+
+  std::vector<Result> results;
+  std::string line;
+  while (std::getline(file, line)) {
+    size_t nameStart = line.find("\"name\": \"");
+    if (nameStart == std::string::npos) {
+      continue;
+    }
+    nameStart += 9;
+    size_t nameEnd = line.find('"', nameStart);
+
+    Result result;
+    result.name = line.substr(nameStart, nameEnd - nameStart);
+    result.nsPerOp = readNumber(line, "ns_per_op");
+    result.minNsPerOp = readNumber(line, "min_ns_per_op");
+    result.iterations = static_cast<uint64_t>(readNumber(line, "iterations"));
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+int Jetpack::Bench::compare(const std::vector<Result> &results,
+                            const std::vector<Result> &baseline,
+                            double thresholdPercent) {
+  int regressions = 0;
+
+  std::cout << std::left << std::setw(48) << "benchmark" << std::right
+            << std::setw(14) << "baseline" << std::setw(14) << "current"
+            << std::setw(10) << "change" << std::endl;
+
+  std::cout << std::fixed << std::setprecision(1);
+  for (const auto &result : results) {
+    auto it = std::find_if(
+        baseline.begin(), baseline.end(),
+        [&result](const Result &old) { return old.name == result.name; });
+
+    std::cout << std::left << std::setw(48) << result.name << std::right;
+    if (it == baseline.end() || it->nsPerOp <= 0.0) {
+      std::cout << std::setw(14) << "-" << std::setw(14) << result.nsPerOp
+                << std::setw(10) << "new" << std::endl;
+      continue;
+    }
+
+    const double change = (result.nsPerOp / it->nsPerOp - 1.0) * 100.0;
+    const bool regressed = change > thresholdPercent;
+    regressions += regressed ? 1 : 0;
+
+    std::cout << std::setw(14) << it->nsPerOp << std::setw(14)
+              << result.nsPerOp << std::setw(9) << std::showpos << change
+              << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "")
+              << std::endl;
+  }
+
+  return regressions;
+}
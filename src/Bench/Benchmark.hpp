@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Jetpack::Bench {
+struct Result {
+  std::string name;
+  double nsPerOp = 0.0;
+  double minNsPerOp = 0.0;
+  uint64_t iterations = 0;
+};
+
+// Keeps the compiler from discarding a computation whose result is unused.
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Runner {
+public:
+  // The body runs the measured operation the given number of times.
+  using Body = std::function<void(uint64_t iterations)>;
+
+  void add(std::string name, Body body);
+  std::vector<Result> run(const std::string &filter) const;
+
+private:
+  static constexpr double CALIBRATION_TARGET_NS = 10e6;
+  static constexpr double SAMPLE_TARGET_NS = 50e6;
+  static constexpr int SAMPLE_COUNT = 7;
+
+  struct Benchmark {
+    std::string name;
+    Body body;
+  };
+
+  static double measure(const Body &body, uint64_t iterations);
+
+  std::vector<Benchmark> m_benchmarks;
+};
+
+void printResults(const std::vector<Result> &results);
+void writeJson(const std::string &path, const std::vector<Result> &results);
+std::vector<Result> readJson(const std::string &path);
+
+// Prints each result against the baseline and returns the number of
+// benchmarks that got slower by more than thresholdPercent.
+int compare(const std::vector<Result> &results,
+            const std::vector<Result> &baseline, double thresholdPercent);
+} // namespace Jetpack::Bench
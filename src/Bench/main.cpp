@@ -0,0 +1,293 @@
+#include "../Server/Broadcaster.hpp"
+#include "../Server/MapLoader.hpp"
+#include "../Server/Match.hpp"
+#include "../Server/MatchPool.hpp"
+#include "../Shared/PacketCodec.hpp"
+#include "../Shared/Physics.hpp"
+#include "Benchmark.hpp"
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace Jetpack::Server {
+// Drives individual Match update phases, which are private to the server.
+struct MatchBenchmarkAccess {
+  static PlayerMap &getPlayers(Match &match) { return match.m_players; }
+  static void checkCollisions(Match &match) { match.checkCollisions(); }
+};
+} // namespace Jetpack::Server
+
+using namespace Jetpack;
+using Shared::Protocol::PlayerState;
+
+namespace {
+constexpr int MAP_HEIGHT = 10;
+
+std::string makeMapText(int width, int height, bool withHazards) {
+  std::mt19937 random(42);
+  std::string text;
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const unsigned roll = random() % 100;
+      if (roll < 10) {
+        text += 'c';
+      } else if (withHazards && roll < 13) {
+        text += 'e';
+      } else if (withHazards && roll < 14) {
+        text += 'z';
+      } else {
+        text += '_';
+      }
+    }
+    text += '\n';
+  }
+  return text;
+}
+
+Server::MapTemplate makeMapTemplate(int width, bool withHazards) {
+  Server::MapTemplate mapTemplate;
+  std::istringstream input(makeMapText(width, MAP_HEIGHT, withHazards));
+  Server::MapLoader::load(input, mapTemplate);
+  return mapTemplate;
+}
+
+// A started match whose players are all PLAYING and spread across the map.
+class MatchFixture {
+public:
+  MatchFixture(int playerCount, int mapWidth)
+      : m_mapTemplate(makeMapTemplate(mapWidth, false)),
+        m_config(makeConfig(playerCount)), m_pool(m_config, {}) {
+    m_match = m_pool.acquire(m_mapTemplate);
+    for (int i = 0; i < playerCount; i++) {
+      m_match->addPlayer(-1 - i);
+    }
+    m_match->checkGameStart();
+    m_match->updateGameState();
+    resetPlayers();
+  }
+
+  ~MatchFixture() { m_pool.release(m_match); }
+
+  Server::Match &getMatch() { return *m_match; }
+
+  void resetPlayers() {
+    float x = 1.0f;
+    for (auto &[_, player] :
+         Server::MatchBenchmarkAccess::getPlayers(*m_match)) {
+      player.setState(PlayerState::PLAYING);
+      player.setPosition(x, MAP_HEIGHT / 2.0f);
+      player.setJetpacking(player.getId() % 2 == 0);
+      x += 0.37f;
+    }
+  }
+
+private:
+  static Server::ServerConfig makeConfig(int playerCount) {
+    Server::ServerConfig config;
+    config.playersPerMatch = playerCount;
+    return config;
+  }
+
+  Server::MapTemplate m_mapTemplate;
+  Server::ServerConfig m_config;
+  Server::MatchPool m_pool;
+  Server::Match *m_match = nullptr;
+};
+
+std::vector<uint8_t> makeGameStatePacket(int playerCount) {
+  std::vector<uint8_t> packet(Shared::PacketCodec::GAME_STATE_HEADER_SIZE +
+                              playerCount *
+                                  Shared::PacketCodec::PLAYER_STATE_SIZE);
+  packet[0] =
+      static_cast<uint8_t>(Shared::Protocol::PacketType::GAME_STATE_UPDATE);
+  packet[1] = playerCount;
+  for (int i = 0; i < playerCount; i++) {
+    uint8_t *player = packet.data() +
+                      Shared::PacketCodec::GAME_STATE_HEADER_SIZE +
+                      i * Shared::PacketCodec::PLAYER_STATE_SIZE;
+    player[0] = i + 1;
+    player[1] = static_cast<uint8_t>(PlayerState::PLAYING);
+    player[2] = i;
+    player[4] = 200;
+    player[8] = i % 2;
+  }
+  return packet;
+}
+
+void registerPhysics(Bench::Runner &runner) {
+  runner.add("physics/applyPhysics", [](uint64_t iterations) {
+    Shared::Protocol::Player player(-1, 1);
+    player.setPosition(1.0f, 5.0f);
+    for (uint64_t i = 0; i < iterations; i++) {
+      player.setJetpacking((i & 64) != 0);
+      Shared::Physics::applyPhysics(player);
+      Bench::doNotOptimize(player);
+    }
+  });
+
+  runner.add("physics/checkBounds", [](uint64_t iterations) {
+    Server::MapTemplate mapTemplate = makeMapTemplate(1000, false);
+    Shared::Protocol::Player player(-1, 1);
+    for (uint64_t i = 0; i < iterations; i++) {
+      player.setPosition((i % 1000) * 1.0f, (i % 13) - 1.0f);
+      Shared::Physics::checkBounds(player, mapTemplate.map);
+      Bench::doNotOptimize(player);
+    }
+  });
+}
+
+void registerMatch(Bench::Runner &runner) {
+  for (int players : {2, 32, 255}) {
+    runner.add("match/checkCollisions/" + std::to_string(players) + "p",
+               [players](uint64_t iterations) {
+                 MatchFixture fixture(players, 1000);
+                 for (uint64_t i = 0; i < iterations; i++) {
+                   Server::MatchBenchmarkAccess::checkCollisions(
+                       fixture.getMatch());
+                 }
+               });
+
+    runner.add("match/updateGameState/" + std::to_string(players) + "p",
+               [players](uint64_t iterations) {
+                 MatchFixture fixture(players, 1000);
+                 for (uint64_t i = 0; i < iterations; i++) {
+                   if (i % 4096 == 4095) {
+                     fixture.resetPlayers();
+                   }
+                   fixture.getMatch().updateGameState();
+                 }
+               });
+  }
+}
+
+void registerMapLoader(Bench::Runner &runner) {
+  for (int width : {100, 1000, 10000}) {
+    const std::string text = makeMapText(width, MAP_HEIGHT, true);
+    runner.add("server/loadMap/" + std::to_string(width) + "x" +
+                   std::to_string(MAP_HEIGHT),
+               [text](uint64_t iterations) {
+                 for (uint64_t i = 0; i < iterations; i++) {
+                   Server::MapTemplate mapTemplate;
+                   std::istringstream input(text);
+                   Bench::doNotOptimize(
+                       Server::MapLoader::load(input, mapTemplate));
+                 }
+               });
+  }
+}
+
+void registerBroadcaster(Bench::Runner &runner) {
+  for (int players : {2, 32, 255}) {
+    runner.add("broadcaster/broadcastGameState/" + std::to_string(players) +
+                   "p",
+               [players](uint64_t iterations) {
+                 Server::PlayerMap playerMap;
+                 for (int i = 0; i < players; i++) {
+                   playerMap.emplace(-1 - i, Shared::Protocol::Player(
+                                                 -1 - i, i + 1));
+                 }
+                 Server::Broadcaster broadcaster(playerMap);
+                 for (uint64_t i = 0; i < iterations; i++) {
+                   broadcaster.broadcastGameState(i);
+                 }
+               });
+  }
+}
+
+void registerClientParsing(Bench::Runner &runner) {
+  runner.add("client/getPacketSize", [](uint64_t iterations) {
+    std::vector<uint8_t> stream = makeGameStatePacket(2);
+    const uint8_t others[] = {0x08, 1, 2, 3, 4, 0x09, 1, 0x0A, 1, 1};
+    stream.insert(stream.end(), std::begin(others), std::end(others));
+
+    for (uint64_t i = 0; i < iterations; i++) {
+      size_t offset = 0;
+      while (offset < stream.size()) {
+        offset += Shared::PacketCodec::getPacketSize(stream.data() + offset,
+                                                     stream.size() - offset);
+      }
+      Bench::doNotOptimize(offset);
+    }
+  });
+
+  for (int players : {2, 32, 255}) {
+    runner.add("client/decodeGameStateUpdate/" + std::to_string(players) +
+                   "p",
+               [players](uint64_t iterations) {
+                 const std::vector<uint8_t> packet =
+                     makeGameStatePacket(players);
+                 std::vector<Shared::Protocol::Player> playerList;
+                 for (uint64_t i = 0; i < iterations; i++) {
+                   Shared::PacketCodec::decodeGameStateUpdate(
+                       packet.data(), packet.size(), playerList);
+                   Bench::doNotOptimize(playerList.data());
+                 }
+               });
+  }
+}
+
+void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name
+            << " [-f <filter>] [-o <results.json>] [-c <baseline.json>]"
+               " [-r <regression %>]"
+            << std::endl;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string filter;
+  std::string outputFile;
+  std::string baselineFile;
+  double threshold = 10.0;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-f" && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "-o" && i + 1 < argc) {
+      outputFile = argv[++i];
+    } else if (arg == "-c" && i + 1 < argc) {
+      baselineFile = argv[++i];
+    } else if (arg == "-r" && i + 1 < argc) {
+      threshold = std::stod(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  Bench::Runner runner;
+  registerPhysics(runner);
+  registerMatch(runner);
+  registerMapLoader(runner);
+  registerBroadcaster(runner);
+  registerClientParsing(runner);
+
+  try {
+    std::vector<Bench::Result> results = runner.run(filter);
+
+    if (!outputFile.empty()) {
+      Bench::writeJson(outputFile, results);
+    }
+
+    if (baselineFile.empty()) {
+      Bench::printResults(results);
+      return 0;
+    }
+
+    int regressions =
+        Bench::compare(results, Bench::readJson(baselineFile), threshold);
+    if (regressions > 0) {
+      std::cerr << regressions << " benchmark(s) regressed by more than "
+                << threshold << "%" << std::endl;
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
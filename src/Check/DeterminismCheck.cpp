@@ -0,0 +1,195 @@
+#include "DeterminismCheck.hpp"
+#include "../Server/MapLoader.hpp"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+// A mix that keeps players spread over the rows, dying on hazards and
+// racing for the same coins.
+const std::array<const char *, 6> POLICIES = {
+    "greedy", "random:5", "hover", "pulse:8/8", "random:20", "hover:2"};
+} // namespace
+
+Jetpack::Check::DeterminismCheck::Lane::Lane(
+    const Server::MapTemplate &mapTemplate,
+    const Server::ServerConfig &serverConfig,
+    const Server::MatchServices &services, size_t index,
+    const CheckConfig &config)
+    : m_runner(serverConfig, services),
+      m_match(m_runner.createMatch(mapTemplate)) {
+  // Headless players use negative keys; slot i joins as player id i + 1.
+  for (size_t slot = 0; slot < config.players; slot++) {
+    m_policies.push_back(Batch::InputPolicy::create(
+        POLICIES[slot % POLICIES.size()],
+        config.seed + index * config.players + slot));
+    m_match->addPlayer(-1 - static_cast<int>(slot));
+  }
+  m_match->checkGameStart();
+  capture(*m_match);
+}
+
+void Jetpack::Check::DeterminismCheck::Lane::step(uint32_t maxSteps) {
+  for (size_t slot = 0; slot < m_policies.size(); slot++) {
+    const int key = -1 - static_cast<int>(slot);
+    auto it = m_match->getPlayers().find(key);
+    if (it != m_match->getPlayers().end()) {
+      m_match->setPlayerInput(
+          key, m_policies[slot]->decide(it->second, *m_match), 0);
+    }
+  }
+
+  if (m_match->getStep() >= maxSteps) {
+    m_match->forceEnd();
+  }
+  // The match is released once over, so its last step is captured here.
+  m_runner.tick([this](const Server::Match &over) {
+    capture(over);
+    m_finished = true;
+  });
+  if (!m_finished) {
+    capture(*m_match);
+  }
+}
+
+void Jetpack::Check::DeterminismCheck::Lane::capture(
+    const Server::Match &match) {
+  m_record.gameState = match.getGameState();
+  m_record.step = match.getStep();
+  m_record.winnerId = match.getWinnerId();
+
+  // Indexed by player id, since the player map has no stable order.
+  m_record.players.assign(m_policies.size(), {});
+  for (const auto &[_, player] : match.getPlayers()) {
+    const size_t index = player.getId() - 1;
+    if (index >= m_record.players.size()) {
+      continue;
+    }
+    StepRecord::PlayerRecord &record = m_record.players[index];
+    record.id = player.getId();
+    record.state = player.getState();
+    record.x = player.getPosition().x;
+    record.y = player.getPosition().y;
+    record.velocityY = player.getVelocityY();
+    record.jetpacking = player.isJetpacking();
+    record.score = player.getScore();
+  }
+}
+
+Jetpack::Check::DeterminismCheck::DeterminismCheck(
+    const CheckConfig &config, const Server::MapTemplate *mapTemplate)
+    : m_config(config), m_mapTemplate(mapTemplate),
+      m_threadPool(std::max<size_t>(config.threads, 2)) {
+  m_serverConfig.playersPerMatch = config.players;
+}
+
+// Dense coins for the players to contest, and hazards rare enough that a
+// match, which ends at the first death, still runs for a while.
+Jetpack::Server::MapTemplate
+Jetpack::Check::DeterminismCheck::generateMap(uint32_t seed) {
+  std::mt19937 random(seed);
+  std::string text;
+  for (int y = 0; y < GENERATED_MAP_HEIGHT; y++) {
+    for (int x = 0; x < GENERATED_MAP_WIDTH; x++) {
+      const unsigned roll = random() % 1000;
+      if (roll < 200) {
+        text += 'c';
+      } else if (roll < 203) {
+        text += 'e';
+      } else if (roll < 204) {
+        text += 'z';
+      } else {
+        text += '_';
+      }
+    }
+    text += '\n';
+  }
+
+  Server::MapTemplate mapTemplate;
+  std::istringstream input(text);
+  Server::MapLoader::load(input, mapTemplate);
+  return mapTemplate;
+}
+
+bool Jetpack::Check::DeterminismCheck::run(std::ostream &output) {
+  for (size_t index = 0; index < m_config.matches; index++) {
+    const bool same =
+        m_mapTemplate
+            ? runMatch(index, *m_mapTemplate, output)
+            : runMatch(index, generateMap(m_config.seed + index), output);
+    if (!same) {
+      return false;
+    }
+  }
+  output << m_config.matches << " matches of " << m_config.players
+         << " players identical on " << m_threadPool.getThreadCount()
+         << " threads" << std::endl;
+  return true;
+}
+
+bool Jetpack::Check::DeterminismCheck::runMatch(
+    size_t index, const Server::MapTemplate &mapTemplate,
+    std::ostream &output) {
+  Server::MatchServices serialServices;
+  serialServices.offline = true;
+  Server::MatchServices parallelServices = serialServices;
+  parallelServices.threadPool = &m_threadPool;
+
+  Lane serial(mapTemplate, m_serverConfig, serialServices, index, m_config);
+  Lane parallel(mapTemplate, m_serverConfig, parallelServices, index,
+                m_config);
+
+  while (true) {
+    if (serial.getRecord() != parallel.getRecord() ||
+        serial.isFinished() != parallel.isFinished()) {
+      output << "match " << index << " diverged:\n";
+      describe(serial.getRecord(), parallel.getRecord(), output);
+      return false;
+    }
+    if (serial.isFinished()) {
+      break;
+    }
+    serial.step(m_config.maxSteps);
+    parallel.step(m_config.maxSteps);
+  }
+
+  const StepRecord &result = serial.getRecord();
+  int coins = 0;
+  for (const StepRecord::PlayerRecord &player : result.players) {
+    coins += player.score;
+  }
+  output << "match " << index << ": " << result.step << " steps, " << coins
+         << " coins, winner " << result.winnerId << std::endl;
+  return true;
+}
+
+void Jetpack::Check::DeterminismCheck::describe(const StepRecord &serial,
+                                                const StepRecord &parallel,
+                                                std::ostream &output) {
+  auto printMatch = [&output](const char *label, const StepRecord &record) {
+    output << "  " << label << " step " << record.step << " state "
+           << static_cast<int>(record.gameState) << " winner "
+           << record.winnerId << "\n";
+  };
+  auto printPlayer = [&output](const char *label,
+                               const StepRecord::PlayerRecord &player) {
+    output << "  " << label << " player " << player.id << " state "
+           << static_cast<int>(player.state) << " at (" << player.x << ", "
+           << player.y << ") velocity " << player.velocityY
+           << (player.jetpacking ? " jetpacking" : "") << " score "
+           << player.score << "\n";
+  };
+
+  printMatch("serial  ", serial);
+  printMatch("parallel", parallel);
+  const size_t count =
+      std::min(serial.players.size(), parallel.players.size());
+  for (size_t i = 0; i < count; i++) {
+    if (serial.players[i] != parallel.players[i]) {
+      printPlayer("serial  ", serial.players[i]);
+      printPlayer("parallel", parallel.players[i]);
+    }
+  }
+}
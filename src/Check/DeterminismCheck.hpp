@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../Batch/InputPolicy.hpp"
+#include "../Server/Match.hpp"
+#include "../Server/MatchRunner.hpp"
+#include "../Server/ThreadPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace Jetpack::Check {
+struct CheckConfig {
+  size_t players = 64;
+  size_t threads = 4;
+  size_t matches = 4;
+  uint32_t seed = 1;
+  uint32_t maxSteps = 5000;
+};
+
+// What a step left behind: the match state and every player.
+struct StepRecord {
+  struct PlayerRecord {
+    int id = 0;
+    Shared::Protocol::PlayerState state =
+        Shared::Protocol::PlayerState::CONNECTED;
+    float x = 0.0f;
+    float y = 0.0f;
+    float velocityY = 0.0f;
+    bool jetpacking = false;
+    int score = 0;
+
+    bool operator==(const PlayerRecord &) const = default;
+  };
+
+  Shared::Protocol::GameState gameState =
+      Shared::Protocol::GameState::WAITING_FOR_PLAYERS;
+  uint32_t step = 0;
+  int winnerId = -1;
+  std::vector<PlayerRecord> players;
+
+  bool operator==(const StepRecord &) const = default;
+};
+
+// Plays the same seeded matches through the serial player update and
+// through Match::simulatePlayersParallel, in lockstep, and compares the
+// players after every step. The parallel path must match the serial one
+// exactly, down to which player takes a contested coin.
+class DeterminismCheck {
+public:
+  // Without a map, every match plays its own map generated from its seed.
+  DeterminismCheck(const CheckConfig &config,
+                   const Server::MapTemplate *mapTemplate);
+
+  // Describes the first difference on output and returns false if any.
+  bool run(std::ostream &output);
+
+private:
+  // One side of the comparison: a runner with its match and input policies.
+  class Lane {
+  public:
+    Lane(const Server::MapTemplate &mapTemplate,
+         const Server::ServerConfig &serverConfig,
+         const Server::MatchServices &services, size_t index,
+         const CheckConfig &config);
+
+    void step(uint32_t maxSteps);
+    bool isFinished() const { return m_finished; }
+    const StepRecord &getRecord() const { return m_record; }
+
+  private:
+    void capture(const Server::Match &match);
+
+    Server::MatchRunner m_runner;
+    Server::Match *m_match;
+    std::vector<std::unique_ptr<Batch::InputPolicy>> m_policies;
+    StepRecord m_record;
+    bool m_finished = false;
+  };
+
+  static constexpr int GENERATED_MAP_WIDTH = 400;
+  static constexpr int GENERATED_MAP_HEIGHT = 10;
+
+  static Server::MapTemplate generateMap(uint32_t seed);
+  bool runMatch(size_t index, const Server::MapTemplate &mapTemplate,
+                std::ostream &output);
+  static void describe(const StepRecord &serial, const StepRecord &parallel,
+                       std::ostream &output);
+
+  CheckConfig m_config;
+  const Server::MapTemplate *m_mapTemplate;
+  Server::ServerConfig m_serverConfig;
+  Server::ThreadPool m_threadPool;
+};
+} // namespace Jetpack::Check
@@ -0,0 +1,71 @@
+#include "../Server/MapLoader.hpp"
+#include "../Shared/Exceptions.hpp"
+#include "DeterminismCheck.hpp"
+#include <fstream>
+#include <iostream>
+
+static void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name
+            << " [-m <map>] [-p <players>] [-n <matches>] [-t <threads>]"
+               " [-S <seed>] [-l <step limit>]"
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  Jetpack::Check::CheckConfig config;
+  std::string mapFile;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-m" && i + 1 < argc) {
+      mapFile = argv[++i];
+    } else if (arg == "-p" && i + 1 < argc) {
+      config.players = std::stoul(argv[++i]);
+    } else if (arg == "-n" && i + 1 < argc) {
+      config.matches = std::stoul(argv[++i]);
+    } else if (arg == "-t" && i + 1 < argc) {
+      config.threads = std::stoul(argv[++i]);
+    } else if (arg == "-S" && i + 1 < argc) {
+      config.seed = std::stoul(argv[++i]);
+    } else if (arg == "-l" && i + 1 < argc) {
+      config.maxSteps = std::stoul(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Below the threshold both sides would take the serial path.
+  const size_t minPlayers =
+      Jetpack::Server::Match::PARALLEL_PLAYERS_THRESHOLD;
+  if (config.players < minPlayers || config.players > 255) {
+    std::cerr << "Error: Between " << minPlayers
+              << " and 255 players are required" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    Jetpack::Server::MapTemplate mapTemplate;
+    if (!mapFile.empty()) {
+      std::ifstream file(mapFile);
+      if (!file.is_open() ||
+          !Jetpack::Server::MapLoader::load(file, mapTemplate)) {
+        throw Jetpack::Shared::Exceptions::MapLoaderException(
+            "Failed to load map file: " + mapFile);
+      }
+    }
+
+    Jetpack::Check::DeterminismCheck check(
+        config, mapFile.empty() ? nullptr : &mapTemplate);
+    if (!check.run(std::cout)) {
+      return 2;
+    }
+  } catch (const Jetpack::Shared::Exceptions::Exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,7 +1,48 @@
 #include "GameDisplay.hpp"
+#include "../Shared/Trace.hpp"
 
 #include <iostream>
 #include <cmath>
+#include <utility>
+
+namespace {
+const sf::Color PARALLAX_BASE_COLOR(20, 20, 50);
+const sf::Color PARALLAX_OVERLAY_COLOR(0, 0, 30, 50);
+
+// Composes the whole parallax background in one pass: the base colour, each
+// layer repeated horizontally at its offset, scaled, centred and tinted,
+// then the overlay. Blending matches drawing the layers one over the other.
+// Texture coordinates carry the window position of the fragment.
+constexpr const char *PARALLAX_SHADER = R"(
+uniform sampler2D texture;
+uniform vec2 textureSize;
+uniform float screenHeight;
+uniform vec4 baseColor;
+uniform vec4 overlayColor;
+uniform int layerCount;
+uniform float layerScale[4];
+uniform float layerOffset[4];
+uniform vec4 layerTint[4];
+
+void main() {
+  vec2 pixel = gl_TexCoord[0].xy;
+  vec3 color = baseColor.rgb;
+  for (int i = 0; i < 4; i++) {
+    if (i >= layerCount) {
+      break;
+    }
+    vec2 size = textureSize * layerScale[i];
+    float v = (pixel.y - (screenHeight - size.y) / 2.0) / size.y;
+    if (v >= 0.0 && v < 1.0) {
+      float u = fract((pixel.x + layerOffset[i]) / size.x);
+      vec4 texel = texture2D(texture, vec2(u, v)) * layerTint[i];
+      color = mix(color, texel.rgb, texel.a);
+    }
+  }
+  gl_FragColor = vec4(mix(color, overlayColor.rgb, overlayColor.a), 1.0);
+}
+)";
+} // namespace
 
 Jetpack::Client::GameDisplay::GameDisplay(int windowWidth, int windowHeight)
     : m_window(sf::VideoMode(windowWidth, windowHeight), "Jetpack") {
@@ -27,19 +68,18 @@ void Jetpack::Client::GameDisplay::loadResources() {
   if (!m_backgroundTexture.loadFromFile("./resources/background.png")) {
     std::cerr << "Failed to load background.png!" << std::endl;
   }
-  if (!m_playerSpritesheet.loadFromFile("./resources/player_sprite_sheet.png")) {
-    std::cerr << "Failed to load player_sprite_sheet.png!" << std::endl;
-  }
-  if (!m_coinSpritesheet.loadFromFile("./resources/coins_sprite_sheet.png")) {
-    std::cerr << "Failed to load coins_sprite_sheet.png!" << std::endl;
-  }
-  if (!m_zapperSpritesheet.loadFromFile("./resources/zapper_sprite_sheet.png")) {
-    std::cerr << "Failed to load zapper_sprite_sheet.png!" << std::endl;
-  }
+  const sf::Vector2i playerOrigin =
+      m_atlas.add("./resources/player_sprite_sheet.png");
+  const sf::Vector2i coinOrigin =
+      m_atlas.add("./resources/coins_sprite_sheet.png");
+  const sf::Vector2i zapperOrigin =
+      m_atlas.add("./resources/zapper_sprite_sheet.png");
+  m_atlas.build();
 
   initializeParallaxBackgrounds();
+  initializeHud();
   loadSounds();
-  initializeAnimations();
+  initializeAnimations(playerOrigin, coinOrigin, zapperOrigin);
 }
 
 void Jetpack::Client::GameDisplay::initializeParallaxBackgrounds() {
@@ -95,6 +135,53 @@ void Jetpack::Client::GameDisplay::initializeParallaxBackgrounds() {
     m_parallaxLayers.push_back(layer);
     m_parallaxSpeeds.push_back(speeds[i]);
   }
+
+  initializeParallaxShader();
+}
+
+void Jetpack::Client::GameDisplay::initializeParallaxShader() {
+  m_parallaxShaderReady = false;
+  if (m_parallaxLayers.size() > MAX_PARALLAX_LAYERS ||
+      !sf::Shader::isAvailable()) {
+    return;
+  }
+  if (!m_parallaxShader.loadFromMemory(PARALLAX_SHADER,
+                                       sf::Shader::Fragment)) {
+    std::cerr << "Failed to compile the parallax shader, drawing layers "
+                 "separately" << std::endl;
+    return;
+  }
+
+  std::vector<float> scales;
+  std::vector<sf::Glsl::Vec4> tints;
+  for (const sf::Sprite &layer : m_parallaxLayers) {
+    scales.push_back(layer.getScale().x);
+    tints.emplace_back(layer.getColor());
+  }
+  m_parallaxShader.setUniform("texture", m_backgroundTexture);
+  m_parallaxShader.setUniform(
+      "textureSize", sf::Glsl::Vec2(m_backgroundTexture.getSize()));
+  m_parallaxShader.setUniform("screenHeight",
+                              static_cast<float>(m_window.getSize().y));
+  m_parallaxShader.setUniform("baseColor",
+                              sf::Glsl::Vec4(PARALLAX_BASE_COLOR));
+  m_parallaxShader.setUniform("overlayColor",
+                              sf::Glsl::Vec4(PARALLAX_OVERLAY_COLOR));
+  m_parallaxShader.setUniform("layerCount",
+                              static_cast<int>(m_parallaxLayers.size()));
+  m_parallaxShader.setUniformArray("layerScale", scales.data(),
+                                   scales.size());
+  m_parallaxShader.setUniformArray("layerTint", tints.data(), tints.size());
+
+  const float width = static_cast<float>(m_window.getSize().x);
+  const float height = static_cast<float>(m_window.getSize().y);
+  m_parallaxQuad.setPrimitiveType(sf::Quads);
+  m_parallaxQuad.resize(4);
+  m_parallaxQuad[0] = sf::Vertex({0.0f, 0.0f}, {0.0f, 0.0f});
+  m_parallaxQuad[1] = sf::Vertex({width, 0.0f}, {width, 0.0f});
+  m_parallaxQuad[2] = sf::Vertex({width, height}, {width, height});
+  m_parallaxQuad[3] = sf::Vertex({0.0f, height}, {0.0f, height});
+  m_parallaxShaderReady = true;
 }
 
 
@@ -105,9 +192,8 @@ void Jetpack::Client::GameDisplay::updateParallaxBackgrounds(float deltaTime) {
 
   
   float playerX = 0.0f;
-  std::lock_guard<std::mutex> lock(m_dataMutex);
 
-  for (const auto &player : m_players) {
+  for (const auto &player : m_playerSnapshots.front().players) {
     if (player.getId() == m_localPlayerId) {
       playerX = player.getPosition().x;
       break;
@@ -168,19 +254,24 @@ void Jetpack::Client::GameDisplay::loadSounds() {
   m_gameMusic.play();
 }
 
-void Jetpack::Client::GameDisplay::initializeAnimations() {
+void Jetpack::Client::GameDisplay::initializeAnimations(
+    const sf::Vector2i playerOrigin, const sf::Vector2i coinOrigin,
+    const sf::Vector2i zapperOrigin) {
   const int playerFrameWidth = 134;
   const int playerFrameHeight = 134;
   const int numPlayerRunFrames = 4;
 
   for (int i = 0; i < numPlayerRunFrames; i++) {
-    sf::IntRect frame(i * playerFrameWidth, 0, playerFrameWidth, playerFrameHeight);
+    sf::IntRect frame(playerOrigin.x + i * playerFrameWidth, playerOrigin.y,
+                      playerFrameWidth, playerFrameHeight);
     m_playerRunFrames.push_back(frame);
   }
 
   const int numPlayerJetpackFrames = 4;
   for (int i = 0; i < numPlayerJetpackFrames; i++) {
-    sf::IntRect frame(i * playerFrameWidth, playerFrameHeight, playerFrameWidth, playerFrameHeight);
+    sf::IntRect frame(playerOrigin.x + i * playerFrameWidth,
+                      playerOrigin.y + playerFrameHeight, playerFrameWidth,
+                      playerFrameHeight);
     m_playerJetpackFrames.push_back(frame);
   }
 
@@ -188,7 +279,8 @@ void Jetpack::Client::GameDisplay::initializeAnimations() {
   const int coinFrameHeight = 171;
   const int numCoinFrames = 6;
   for (int i = 0; i < numCoinFrames; i++) {
-    sf::IntRect frame(i * coinFrameWidth, 0, coinFrameWidth, coinFrameHeight);
+    sf::IntRect frame(coinOrigin.x + i * coinFrameWidth, coinOrigin.y,
+                      coinFrameWidth, coinFrameHeight);
     m_coinFrames.push_back(frame);
   }
 
@@ -196,7 +288,8 @@ void Jetpack::Client::GameDisplay::initializeAnimations() {
   const int zapperFrameHeight = 122;
   const int numZapperFrames = 4;
   for (int i = 0; i < numZapperFrames; i++) {
-    sf::IntRect frame(i * zapperFrameWidth, 0, zapperFrameWidth, zapperFrameHeight);
+    sf::IntRect frame(zapperOrigin.x + i * zapperFrameWidth, zapperOrigin.y,
+                      zapperFrameWidth, zapperFrameHeight);
     m_zapperFrames.push_back(frame);
   }
 }
@@ -204,13 +297,26 @@ void Jetpack::Client::GameDisplay::initializeAnimations() {
 void Jetpack::Client::GameDisplay::run() {
   m_animationClock.restart();
   sf::Clock deltaClock;
+  Shared::Trace::setThreadName("render");
 
   while (m_window.isOpen()) {
+    TRACE_SCOPE("frame");
     float deltaTime = deltaClock.restart().asSeconds();
 
-    processEvents();
-    updateAnimations();
-    updateParallaxBackgrounds(deltaTime);
+    {
+      TRACE_SCOPE("processEvents");
+      processEvents();
+    }
+    {
+      TRACE_SCOPE("applyUpdates");
+      applyUpdates();
+    }
+    {
+      TRACE_SCOPE("updateAnimations");
+      updateAnimations();
+      updateParallaxBackgrounds(deltaTime);
+    }
+    TRACE_SCOPE("render");
     render();
   }
 }
@@ -226,11 +332,9 @@ void Jetpack::Client::GameDisplay::updateAnimations() {
 }
 
 void Jetpack::Client::GameDisplay::handleJetpackSounds() {
-  std::lock_guard<std::mutex> lock(m_dataMutex);
-
   bool anyPlayerJetpacking = false;
 
-  for (const auto &player : m_players) {
+  for (const auto &player : m_playerSnapshots.front().players) {
     if (player.getId() == m_localPlayerId && player.isJetpacking()) {
       anyPlayerJetpacking = true;
       break;
@@ -249,82 +353,138 @@ void Jetpack::Client::GameDisplay::handleJetpackSounds() {
 }
 
 void Jetpack::Client::GameDisplay::processEvents() {
+  bool queued = false;
   sf::Event event;
   while (m_window.pollEvent(event)) {
     if (event.type == sf::Event::Closed) {
       m_window.close();
     }
+    bool jetpackActive = m_jetpackActive;
     if (event.type == sf::Event::KeyPressed &&
         event.key.code == sf::Keyboard::Space) {
-      m_jetpackActive = true;
+      jetpackActive = true;
     } else if (event.type == sf::Event::KeyReleased &&
                event.key.code == sf::Keyboard::Space) {
-      m_jetpackActive = false;
+      jetpackActive = false;
     }
     if (event.type == sf::Event::MouseButtonPressed &&
         event.mouseButton.button == sf::Mouse::Left) {
-      m_jetpackActive = true;
+      jetpackActive = true;
     } else if (event.type == sf::Event::MouseButtonReleased &&
                event.mouseButton.button == sf::Mouse::Left) {
-      m_jetpackActive = false;
+      jetpackActive = false;
     }
+
+    // Each edge is queued, so a press and release within one frame both
+    // reach the server.
+    if (jetpackActive != m_jetpackActive) {
+      m_jetpackActive = jetpackActive;
+      queued |= queueInputEdge();
+    }
+  }
+
+  // Catches up after an edge was dropped on a full queue.
+  queued |= queueInputEdge();
+  if (queued && m_inputListener) {
+    m_inputListener();
+  }
+}
+
+bool Jetpack::Client::GameDisplay::queueInputEdge() {
+  if (!m_inputQueue || m_jetpackActive == m_queuedJetpackActive) {
+    return false;
+  }
+  if (!m_inputQueue->push(
+          {m_jetpackActive, std::chrono::steady_clock::now()})) {
+    return false;
+  }
+
+  m_queuedJetpackActive = m_jetpackActive;
+  if (m_latencyTracker) {
+    m_latencyTracker->onPress();
   }
+  return true;
 }
 
 void Jetpack::Client::GameDisplay::render() {
   m_window.clear(sf::Color(10, 10, 30));
 
-  std::lock_guard<std::mutex> lock(m_dataMutex);
+  if (m_latencyTracker) {
+    m_latencyTracker->onFrameBegin();
+  }
 
   if (m_gameOver) {
+    TRACE_SCOPE("drawGameOver");
     drawGameOver();
   } else {
-    drawParallaxBackgrounds();
-    drawMap();
-    drawPlayers();
+    {
+      TRACE_SCOPE("drawParallaxBackgrounds");
+      drawParallaxBackgrounds();
+    }
+    {
+      TRACE_SCOPE("drawMap");
+      drawMap();
+    }
+    {
+      TRACE_SCOPE("drawEntities");
+      drawEntities();
+    }
+    {
+      TRACE_SCOPE("drawPlayers");
+      drawPlayers();
+    }
+    TRACE_SCOPE("drawUI");
     drawUI();
   }
+
+  TRACE_SCOPE("display");
   m_window.display();
+  if (m_latencyTracker) {
+    m_latencyTracker->onFrameDisplayed();
+  }
 }
 
 void Jetpack::Client::GameDisplay::drawParallaxBackgrounds() {
-  
+  if (m_parallaxShaderReady) {
+    float offsets[MAX_PARALLAX_LAYERS] = {};
+    for (size_t i = 0; i < m_parallaxLayers.size(); i++) {
+      offsets[i] = m_cameraPositionX * m_parallaxSpeeds[i];
+    }
+    m_parallaxShader.setUniformArray("layerOffset", offsets,
+                                     m_parallaxLayers.size());
+
+    sf::RenderStates states;
+    states.shader = &m_parallaxShader;
+    m_window.draw(m_parallaxQuad, states);
+    return;
+  }
+
   sf::RectangleShape darkBackground(sf::Vector2f(m_window.getSize().x, m_window.getSize().y));
-  darkBackground.setFillColor(sf::Color(20, 20, 50));
+  darkBackground.setFillColor(PARALLAX_BASE_COLOR);
   m_window.draw(darkBackground);
 
-  
   for (size_t i = 0; i < m_parallaxLayers.size(); i++) {
-    
     float parallaxOffset = m_cameraPositionX * m_parallaxSpeeds[i];
 
-    
     float spriteWidth = m_backgroundTexture.getSize().x * m_parallaxLayers[i].getScale().x;
     int repetitions = static_cast<int>(std::ceil(m_window.getSize().x / spriteWidth)) + 2;
 
-    
     float startX = -fmodf(parallaxOffset, spriteWidth);
 
-    
     float verticalPosition = (m_window.getSize().y - m_backgroundTexture.getSize().y * m_parallaxLayers[i].getScale().y) / 2.0f;
 
-    
     for (int j = -1; j < repetitions; j++) {
       float posX = startX + j * spriteWidth;
       m_parallaxLayers[i].setPosition(posX, verticalPosition);
 
-      
       if (posX < m_window.getSize().x && posX + spriteWidth > 0) {
         m_window.draw(m_parallaxLayers[i]);
       }
     }
   }
 
-  
   sf::RectangleShape gradientOverlay(sf::Vector2f(m_window.getSize().x, m_window.getSize().y));
-  sf::Color topColor(0, 0, 50, 30);
-  sf::Color bottomColor(0, 0, 30, 50);
-  gradientOverlay.setFillColor(bottomColor);
+  gradientOverlay.setFillColor(PARALLAX_OVERLAY_COLOR);
   m_window.draw(gradientOverlay);
 }
 
@@ -365,25 +525,21 @@ void Jetpack::Client::GameDisplay::drawPlayers() {
 
   float cellHeight = playableHeight / m_map.height;
 
-  for (const auto &player : m_players) {
+  m_batch.clear();
+  for (const auto &player : m_playerSnapshots.front().players) {
     float screenX = (player.getPosition().x - m_cameraPositionX) * cellWidth;
     
     if (screenX < -cellWidth || screenX > m_window.getSize().x + cellWidth) {
       continue;
     }
 
-    sf::Sprite playerSprite(m_playerSpritesheet);
-    if (player.isJetpacking()) {
-      playerSprite.setTextureRect(m_playerJetpackFrames[m_jetpackAnimFrame]);
-    } else {
-      playerSprite.setTextureRect(m_playerRunFrames[m_playerAnimFrame]);
-    }
+    const sf::IntRect &frame = player.isJetpacking()
+                                   ? m_playerJetpackFrames[m_jetpackAnimFrame]
+                                   : m_playerRunFrames[m_playerAnimFrame];
 
     float scale = 0.4f;
-    playerSprite.setScale(scale, scale);
-
-    float spriteWidth = playerSprite.getTextureRect().width * scale;
-    float spriteHeight = playerSprite.getTextureRect().height * scale;
+    float spriteWidth = frame.width * scale;
+    float spriteHeight = frame.height * scale;
     float xPos = screenX + (cellWidth - spriteWidth) / 2;
 
     float yOffset = 10.0f;
@@ -393,26 +549,20 @@ void Jetpack::Client::GameDisplay::drawPlayers() {
     yPos = std::max(yPos, topOffset);
     yPos = std::min(yPos, windowHeight - bottomOffset - spriteHeight);
 
-    playerSprite.setPosition(xPos, yPos);
-
-    if (player.getId() == m_localPlayerId) {
-      playerSprite.setColor(sf::Color(200, 255, 200));
-    } else {
-      playerSprite.setColor(sf::Color(255, 200, 200));
-    }
+    const sf::Color tint = player.getId() == m_localPlayerId
+                               ? sf::Color(200, 255, 200)
+                               : sf::Color(255, 200, 200);
 
     if (m_debugMode) {
-      sf::RectangleShape hitbox;
-      hitbox.setSize(sf::Vector2f(cellWidth * 0.8f, cellHeight * 0.8f));
-      hitbox.setPosition(screenX + cellWidth * 0.1f,
-                         topOffset + (player.getPosition().y / m_map.height) * playableHeight + cellHeight * 0.1f);
-      hitbox.setFillColor(sf::Color(0, 0, 0, 0));
-      hitbox.setOutlineColor(sf::Color::Red);
-      hitbox.setOutlineThickness(1.0f);
-      m_window.draw(hitbox);
+      m_batch.addOutline({screenX + cellWidth * 0.1f,
+                          topOffset + relativePos * playableHeight +
+                              cellHeight * 0.1f,
+                          cellWidth * 0.8f, cellHeight * 0.8f},
+                         m_atlas.getWhiteTexel(), sf::Color::Red);
     }
-    m_window.draw(playerSprite);
+    m_batch.add({xPos, yPos, spriteWidth, spriteHeight}, frame, tint);
   }
+  m_batch.draw(m_window, m_atlas.getTexture());
 }
 
 void Jetpack::Client::GameDisplay::drawMap() {
@@ -442,59 +592,91 @@ void Jetpack::Client::GameDisplay::drawMap() {
     m_window.draw(bottomBoundary);
   }
 
+  const sf::Vector3f layout(cellWidth, cellHeight, topOffset);
+  const size_t chunkCount =
+      (m_map.width + MAP_CHUNK_COLUMNS - 1) / MAP_CHUNK_COLUMNS;
+  if (m_mapChunks.size() != chunkCount || layout.x != m_mapChunkLayout.x ||
+      layout.y != m_mapChunkLayout.y || layout.z != m_mapChunkLayout.z) {
+    m_mapChunks.assign(chunkCount, {});
+    m_mapChunkLayout = layout;
+  }
+
   int startCol = static_cast<int>(m_cameraPositionX);
   startCol = std::max(0, startCol);
   int endCol = static_cast<int>(m_cameraPositionX + visibleMapWidth + 1);
   endCol = std::min(endCol, m_map.width);
-  
+
+  for (int chunk = startCol / MAP_CHUNK_COLUMNS;
+       chunk * MAP_CHUNK_COLUMNS < endCol; chunk++) {
+    MapChunk &mapChunk = m_mapChunks[chunk];
+    if (mapChunk.dirty) {
+      buildMapChunk(chunk);
+    }
+
+    sf::Transform transform;
+    transform.translate(
+        (chunk * MAP_CHUNK_COLUMNS - m_cameraPositionX) * cellWidth, 0.0f);
+    if (m_debugMode) {
+      mapChunk.outlines.draw(m_window, m_atlas.getTexture(), transform);
+    }
+    mapChunk.coins[m_coinAnimFrame].draw(m_window, m_atlas.getTexture(),
+                                         transform);
+    mapChunk.zappers[m_zapperAnimFrame].draw(m_window, m_atlas.getTexture(),
+                                             transform);
+  }
+}
+
+void Jetpack::Client::GameDisplay::buildMapChunk(const int chunk) {
+  const float cellWidth = m_mapChunkLayout.x;
+  const float cellHeight = m_mapChunkLayout.y;
+  const float topOffset = m_mapChunkLayout.z;
+  const int startCol = chunk * MAP_CHUNK_COLUMNS;
+  const int endCol = std::min(startCol + MAP_CHUNK_COLUMNS, m_map.width);
+
+  MapChunk &mapChunk = m_mapChunks[chunk];
+  mapChunk.coins.resize(m_coinFrames.size());
+  mapChunk.zappers.resize(m_zapperFrames.size());
+  for (SpriteBatch &frame : mapChunk.coins) {
+    frame.clear();
+  }
+  for (SpriteBatch &frame : mapChunk.zappers) {
+    frame.clear();
+  }
+  mapChunk.outlines.clear();
+
+  const float coinWidth = m_coinFrames[0].width * 0.2f;
+  const float coinHeight = m_coinFrames[0].height * 0.2f;
+  const float zapperWidth = m_zapperFrames[0].width * 0.6f;
+  const float zapperHeight = m_zapperFrames[0].height * 0.6f;
+
   for (int i = 0; i < m_map.height; i++) {
     for (int j = startCol; j < endCol; j++) {
-      
-      float xPos = (j - m_cameraPositionX) * cellWidth;
-      float yPos = topOffset + i * cellHeight;
-
-      if (m_debugMode && m_map.tiles[i][j] != Shared::Protocol::TileType::EMPTY) {
-        sf::RectangleShape cellHitbox;
-        cellHitbox.setSize(sf::Vector2f(cellWidth * 0.8f, cellHeight * 0.8f));
-        cellHitbox.setPosition(xPos + cellWidth * 0.1f, yPos + cellHeight * 0.1f);
-        cellHitbox.setFillColor(sf::Color(0, 0, 0, 0));
-        cellHitbox.setOutlineColor(sf::Color::Yellow);
-        cellHitbox.setOutlineThickness(1.0f);
-        m_window.draw(cellHitbox);
+      const float xPos = (j - startCol) * cellWidth;
+      const float yPos = topOffset + i * cellHeight;
+
+      if (m_map.tiles[i][j] != Shared::Protocol::TileType::EMPTY) {
+        mapChunk.outlines.addOutline(
+            {xPos + cellWidth * 0.1f, yPos + cellHeight * 0.1f,
+             cellWidth * 0.8f, cellHeight * 0.8f},
+            m_atlas.getWhiteTexel(), sf::Color::Yellow);
       }
 
       switch (m_map.tiles[i][j]) {
       case Shared::Protocol::TileType::COIN:
-        {
-          sf::Sprite coinSprite(m_coinSpritesheet);
-          coinSprite.setTextureRect(m_coinFrames[m_coinAnimFrame]);
-
-          float scale = 0.2f;
-          coinSprite.setScale(scale, scale);
-
-          float spriteWidth = m_coinFrames[0].width * scale;
-          float spriteHeight = m_coinFrames[0].height * scale;
-
-          coinSprite.setPosition(xPos + (cellWidth - spriteWidth) / 2,
-                                yPos + (cellHeight - spriteHeight) / 2);
-
-          m_window.draw(coinSprite);
+        for (size_t frame = 0; frame < m_coinFrames.size(); frame++) {
+          mapChunk.coins[frame].add({xPos + (cellWidth - coinWidth) / 2,
+                                     yPos + (cellHeight - coinHeight) / 2,
+                                     coinWidth, coinHeight},
+                                    m_coinFrames[frame]);
         }
         break;
       case Shared::Protocol::TileType::ELECTRICSQUARE:
-        {
-          sf::Sprite zapperSprite(m_zapperSpritesheet);
-          zapperSprite.setTextureRect(m_zapperFrames[m_zapperAnimFrame]);
-
-          float scale = 0.6f;
-          zapperSprite.setScale(scale, scale);
-
-          float spriteWidth = m_zapperFrames[0].width * scale;
-          float spriteHeight = m_zapperFrames[0].height * scale;
-
-          zapperSprite.setPosition(xPos + (cellWidth - spriteWidth) / 2,
-                                  yPos + (cellHeight - spriteHeight) / 2);
-          m_window.draw(zapperSprite);
+        for (size_t frame = 0; frame < m_zapperFrames.size(); frame++) {
+          mapChunk.zappers[frame].add(
+              {xPos + (cellWidth - zapperWidth) / 2,
+               yPos + (cellHeight - zapperHeight) / 2, zapperWidth,
+               zapperHeight},
+              m_zapperFrames[frame]);
         }
         break;
       default:
@@ -502,152 +684,266 @@ void Jetpack::Client::GameDisplay::drawMap() {
       }
     }
   }
+  mapChunk.dirty = false;
 }
 
-void Jetpack::Client::GameDisplay::drawUI() {
-  if (m_players.empty()) {
-    sf::Text waitingText;
-    waitingText.setFont(m_gameFont);
-    waitingText.setCharacterSize(30);
-    waitingText.setString("Waiting for other players...");
-    waitingText.setFillColor(sf::Color::White);
-
-    sf::FloatRect textRect = waitingText.getLocalBounds();
-    waitingText.setOrigin(textRect.width / 2.0f, textRect.height / 2.0f);
-    waitingText.setPosition(m_window.getSize().x / 2.0f, m_window.getSize().y / 2.0f);
-
-    m_window.draw(waitingText);
+void Jetpack::Client::GameDisplay::drawEntities() {
+  if (m_map.width == 0 || m_map.height == 0 ||
+      m_entitySnapshots.front().empty()) {
     return;
   }
 
-  int yOffset = 10;
-  for (const auto &player : m_players) {
-    sf::Text scoreText;
-    scoreText.setFont(m_gameFont);
-    scoreText.setCharacterSize(20);
-    scoreText.setOutlineThickness(2.0f);
-    scoreText.setOutlineColor(sf::Color::Black);
+  const float cameraZoom = 2.0f;
+  float visibleMapWidth = m_map.width / cameraZoom;
+  float cellWidth = static_cast<float>(m_window.getSize().x) / visibleMapWidth;
+  float windowHeight = static_cast<float>(m_window.getSize().y);
+  float topOffset = m_topBoundary * (windowHeight / m_backgroundHeight);
+  float bottomOffset = m_bottomBoundary * (windowHeight / m_backgroundHeight);
+  float playableHeight = windowHeight - topOffset - bottomOffset;
+
+  float cellHeight = playableHeight / m_map.height;
+
+  m_batch.clear();
+  for (const auto &entity : m_entitySnapshots.front()) {
+    Shared::Protocol::Position extent =
+        Shared::Protocol::getEntityHalfExtent(entity.type);
+    float left = (entity.position.x - extent.x - m_cameraPositionX) * cellWidth;
+    float top = topOffset + (entity.position.y - extent.y) * cellHeight;
+    float width = extent.x * 2.0f * cellWidth;
+    float height = extent.y * 2.0f * cellHeight;
 
-    if (player.getId() == m_localPlayerId) {
-      scoreText.setString("You: " + std::to_string(player.getScore()));
-      scoreText.setFillColor(sf::Color::Green);
-    } else {
-      scoreText.setString("Player " + std::to_string(player.getId()) + ": " +
-                          std::to_string(player.getScore()));
-      scoreText.setFillColor(sf::Color::Red);
+    if (left + width < 0 || left > m_window.getSize().x) {
+      continue;
     }
 
-    scoreText.setPosition(10, yOffset);
-    m_window.draw(scoreText);
-    yOffset += 30;
+    const sf::FloatRect bounds(left, top, width, height);
+    const sf::Vector2f white = m_atlas.getWhiteTexel();
+    switch (entity.type) {
+    case Shared::Protocol::EntityType::ZAPPER:
+      m_batch.add(bounds, m_zapperFrames[m_zapperAnimFrame]);
+      break;
+    case Shared::Protocol::EntityType::MISSILE:
+      m_batch.addSolid({left - 1.0f, top - 1.0f, width + 2.0f, height + 2.0f},
+                       white, sf::Color::Red);
+      m_batch.addSolid(bounds, white, sf::Color(255, 140, 0));
+      break;
+    case Shared::Protocol::EntityType::LASER:
+      m_batch.addSolid(bounds, white,
+                       entity.active ? sf::Color(255, 40, 40, 220)
+                                     : sf::Color(255, 40, 40, 50));
+      break;
+    }
   }
+  m_batch.draw(m_window, m_atlas.getTexture());
 }
 
-void Jetpack::Client::GameDisplay::drawGameOver() {
-  sf::RectangleShape overlay(sf::Vector2f(m_window.getSize().x, m_window.getSize().y));
-  overlay.setFillColor(sf::Color(0, 0, 0, 200));
-  m_window.draw(overlay);
-
-  sf::Text gameOverText;
-  gameOverText.setFont(m_gameFont);
-  gameOverText.setCharacterSize(60);
-  gameOverText.setString("GAME OVER");
-  gameOverText.setFillColor(sf::Color::White);
-  gameOverText.setOutlineThickness(3.0f);
-  gameOverText.setOutlineColor(sf::Color::Black);
-
-  sf::FloatRect textRect = gameOverText.getLocalBounds();
-  gameOverText.setOrigin(textRect.left + textRect.width / 2.0f,
-                       textRect.top + textRect.height / 2.0f);
-  gameOverText.setPosition(m_window.getSize().x / 2.0f,
-                         m_window.getSize().y / 2.0f - 50);
-
-  m_window.draw(gameOverText);
-
-  sf::Text resultText;
-  resultText.setFont(m_gameFont);
-  resultText.setCharacterSize(40);
-  resultText.setOutlineThickness(2.0f);
-  resultText.setOutlineColor(sf::Color::Black);
+void Jetpack::Client::GameDisplay::initializeHud() {
+  const sf::Vector2f center(m_window.getSize().x / 2.0f,
+                            m_window.getSize().y / 2.0f);
+
+  m_waitingText.setFont(m_gameFont);
+  m_waitingText.setCharacterSize(30);
+  m_waitingText.setString("Waiting for other players...");
+  m_waitingText.setFillColor(sf::Color::White);
+  sf::FloatRect textRect = m_waitingText.getLocalBounds();
+  m_waitingText.setOrigin(textRect.width / 2.0f, textRect.height / 2.0f);
+  m_waitingText.setPosition(center.x, center.y);
+
+  m_gameOverOverlay.setSize(sf::Vector2f(m_window.getSize().x,
+                                         m_window.getSize().y));
+  m_gameOverOverlay.setFillColor(sf::Color(0, 0, 0, 200));
+
+  m_gameOverText.setFont(m_gameFont);
+  m_gameOverText.setCharacterSize(60);
+  m_gameOverText.setString("GAME OVER");
+  m_gameOverText.setFillColor(sf::Color::White);
+  m_gameOverText.setOutlineThickness(3.0f);
+  m_gameOverText.setOutlineColor(sf::Color::Black);
+  textRect = m_gameOverText.getLocalBounds();
+  m_gameOverText.setOrigin(textRect.left + textRect.width / 2.0f,
+                           textRect.top + textRect.height / 2.0f);
+  m_gameOverText.setPosition(center.x, center.y - 50);
+
+  m_resultText.setFont(m_gameFont);
+  m_resultText.setCharacterSize(40);
+  m_resultText.setOutlineThickness(2.0f);
+  m_resultText.setOutlineColor(sf::Color::Black);
+}
 
+void Jetpack::Client::GameDisplay::layoutResultText() {
   if (m_winnerId == m_localPlayerId) {
-    resultText.setString("You win!");
-    resultText.setFillColor(sf::Color::Green);
+    m_resultText.setString("You win!");
+    m_resultText.setFillColor(sf::Color::Green);
   } else if (m_winnerId > 0) {
-    resultText.setString("Player " + std::to_string(m_winnerId) + " Wins!");
-    resultText.setFillColor(sf::Color::Red);
+    m_resultText.setString("Player " + std::to_string(m_winnerId) + " Wins!");
+    m_resultText.setFillColor(sf::Color::Red);
   } else {
-    resultText.setString("No winner");
-    resultText.setFillColor(sf::Color::Yellow);
+    m_resultText.setString("No winner");
+    m_resultText.setFillColor(sf::Color::Yellow);
   }
 
-  textRect = resultText.getLocalBounds();
-  resultText.setOrigin(textRect.left + textRect.width / 2.0f,
-                     textRect.top + textRect.height / 2.0f);
-  resultText.setPosition(m_window.getSize().x / 2.0f,
-                       m_window.getSize().y / 2.0f + 50);
-  m_window.draw(resultText);
+  const sf::FloatRect textRect = m_resultText.getLocalBounds();
+  m_resultText.setOrigin(textRect.left + textRect.width / 2.0f,
+                         textRect.top + textRect.height / 2.0f);
+  m_resultText.setPosition(m_window.getSize().x / 2.0f,
+                           m_window.getSize().y / 2.0f + 50);
+}
+
+void Jetpack::Client::GameDisplay::drawUI() {
+  if (m_playerSnapshots.front().players.empty()) {
+    m_window.draw(m_waitingText);
+    return;
+  }
+  m_scoreboard.draw(m_window, {10.0f, 10.0f});
+}
+
+void Jetpack::Client::GameDisplay::drawGameOver() {
+  m_window.draw(m_gameOverOverlay);
+  m_window.draw(m_gameOverText);
+  m_window.draw(m_resultText);
 }
 
 void Jetpack::Client::GameDisplay::updateMap(
     const Shared::Protocol::GameMap &map) {
-  std::lock_guard<std::mutex> lock(m_dataMutex);
-  m_map = map;
+  std::lock_guard<std::mutex> lock(m_eventMutex);
+  m_pendingMap = map;
 }
 
 void Jetpack::Client::GameDisplay::updateGameState(
-    const std::vector<Shared::Protocol::Player> &players) {
-  std::lock_guard<std::mutex> lock(m_dataMutex);
-  std::cout << "Updating game state with " << players.size() << " players"
-            << std::endl;
-  m_players = players;
+    const std::vector<Shared::Protocol::Player> &players, const uint32_t step,
+    const std::chrono::steady_clock::time_point receivedAt,
+    const Predictor &predictor) {
+  auto &back = m_playerSnapshots.back();
+  back.step = step;
+  back.receivedAt = receivedAt;
+  back.players.assign(players.begin(), players.end());
+  back.predictor = predictor;
+  m_playerSnapshots.publish();
+}
+
+void Jetpack::Client::GameDisplay::updateEntities(
+    const std::vector<Shared::Protocol::EntityState> &entities) {
+  auto &back = m_entitySnapshots.back();
+  back.assign(entities.begin(), entities.end());
+  m_entitySnapshots.publish();
 }
 
 void Jetpack::Client::GameDisplay::handleCoinCollected(int playerId, int x,
                                                        int y) {
-  std::lock_guard<std::mutex> lock(m_dataMutex);
+  std::lock_guard<std::mutex> lock(m_eventMutex);
+  m_pendingEvents.push_back({DisplayEvent::Type::COIN, playerId, x, y});
+}
 
-  if (x >= 0 && x < m_map.width && y >= 0 && y < m_map.height) {
-    m_map.tiles[y][x] = Shared::Protocol::TileType::EMPTY;
-  }
+void Jetpack::Client::GameDisplay::handlePlayerDeath(int playerId) {
+  std::lock_guard<std::mutex> lock(m_eventMutex);
+  m_pendingEvents.push_back({DisplayEvent::Type::DEATH, playerId, 0, 0});
+}
 
-  for (auto &player : m_players) {
-    if (player.getId() == playerId) {
-      player.setScore(player.getScore() + 1);
+void Jetpack::Client::GameDisplay::handleGameOver(int winnerId) {
+  std::lock_guard<std::mutex> lock(m_eventMutex);
+  m_pendingEvents.push_back({DisplayEvent::Type::GAME_OVER, winnerId, 0, 0});
+}
 
-      if (playerId == m_localPlayerId) {
-        m_coinPickupSound.play();
-      }
-      break;
+void Jetpack::Client::GameDisplay::applyUpdates() {
+  bool playersChanged = false;
+  if (m_playerSnapshots.update()) {
+    const PlayerSnapshot &snapshot = m_playerSnapshots.front();
+    m_interpolator.addSnapshot(snapshot.step, snapshot.receivedAt,
+                               snapshot.players, m_localPlayerId);
+    playersChanged = true;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  m_interpolator.apply(now, m_playerSnapshots.front().players,
+                       m_localPlayerId);
+  predictLocalPlayer(now);
+  m_entitySnapshots.update();
+
+  {
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    if (m_pendingMap) {
+      m_map = std::move(*m_pendingMap);
+      m_mapChunks.clear();
+      m_pendingMap.reset();
     }
+    m_events.swap(m_pendingEvents);
   }
-}
 
-void Jetpack::Client::GameDisplay::handlePlayerDeath(int playerId) {
-  std::lock_guard<std::mutex> lock(m_dataMutex);
-
-  for (auto &player : m_players) {
-    if (player.getId() == playerId) {
-      player.setState(Shared::Protocol::PlayerState::DEAD);
+  for (const DisplayEvent &event : m_events) {
+    applyEvent(event);
+    playersChanged = true;
+  }
+  m_events.clear();
 
-      if (playerId == m_localPlayerId) {
-        m_zapperSound.play();
-      }
-      break;
-    }
+  if (playersChanged) {
+    m_scoreboard.update(m_playerSnapshots.front().players, m_localPlayerId);
   }
 }
 
-void Jetpack::Client::GameDisplay::handleGameOver(int winnerId) {
-  std::lock_guard<std::mutex> lock(m_dataMutex);
+// Only the motion is predicted: the score and state stay as the snapshot and
+// the events applied since left them, so a death shown by an event sticks.
+void Jetpack::Client::GameDisplay::predictLocalPlayer(
+    const std::chrono::steady_clock::time_point now) {
+  PlayerSnapshot &snapshot = m_playerSnapshots.front();
+  if (!snapshot.predictor.hasSnapshot()) {
+    return;
+  }
 
-  m_gameOver = true;
-  m_winnerId = winnerId;
-  m_jetpackLoopSound.stop();
+  for (auto &player : snapshot.players) {
+    if (player.getId() != m_localPlayerId) {
+      continue;
+    }
+    if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
+      const Shared::Protocol::Player predicted = snapshot.predictor.predict(
+          Predictor::estimateStep(snapshot.step, snapshot.receivedAt, now),
+          m_map);
+      player.setPosition(predicted.getPosition().x,
+                         predicted.getPosition().y);
+      player.setVelocityY(predicted.getVelocityY());
+      player.setJetpacking(predicted.isJetpacking());
+    }
+    break;
+  }
 }
 
-bool Jetpack::Client::GameDisplay::isJetpackActive() const {
-  return m_jetpackActive;
+void Jetpack::Client::GameDisplay::applyEvent(const DisplayEvent &event) {
+  switch (event.type) {
+  case DisplayEvent::Type::COIN:
+    if (event.x >= 0 && event.x < m_map.width && event.y >= 0 &&
+        event.y < m_map.height) {
+      m_map.tiles[event.y][event.x] = Shared::Protocol::TileType::EMPTY;
+      if (static_cast<size_t>(event.x / MAP_CHUNK_COLUMNS) <
+          m_mapChunks.size()) {
+        m_mapChunks[event.x / MAP_CHUNK_COLUMNS].dirty = true;
+      }
+    }
+    for (auto &player : m_playerSnapshots.front().players) {
+      if (player.getId() == event.playerId) {
+        player.setScore(player.getScore() + 1);
+        if (event.playerId == m_localPlayerId) {
+          m_coinPickupSound.play();
+        }
+        break;
+      }
+    }
+    break;
+  case DisplayEvent::Type::DEATH:
+    for (auto &player : m_playerSnapshots.front().players) {
+      if (player.getId() == event.playerId) {
+        player.setState(Shared::Protocol::PlayerState::DEAD);
+        if (event.playerId == m_localPlayerId) {
+          m_zapperSound.play();
+        }
+        break;
+      }
+    }
+    break;
+  case DisplayEvent::Type::GAME_OVER:
+    m_gameOver = true;
+    m_winnerId = event.playerId;
+    layoutResultText();
+    m_jetpackLoopSound.stop();
+    break;
+  }
 }
 
 void Jetpack::Client::GameDisplay::setLocalPlayerId(int id) {
@@ -656,4 +952,22 @@ void Jetpack::Client::GameDisplay::setLocalPlayerId(int id) {
 
 void Jetpack::Client::GameDisplay::setDebugMode(bool debug) {
   m_debugMode = debug;
+}
+
+void Jetpack::Client::GameDisplay::setLatencyTracker(LatencyTracker *tracker) {
+  m_latencyTracker = tracker;
+}
+
+void Jetpack::Client::GameDisplay::setInterpolationDelay(
+    const std::chrono::milliseconds delay) {
+  m_interpolator.setDelay(delay);
+}
+
+void Jetpack::Client::GameDisplay::setInputQueue(InputQueue *queue) {
+  m_inputQueue = queue;
+}
+
+void Jetpack::Client::GameDisplay::setInputListener(
+    std::function<void()> listener) {
+  m_inputListener = std::move(listener);
 }
\ No newline at end of file
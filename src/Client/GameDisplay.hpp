@@ -1,13 +1,44 @@
 #pragma once
 
 #include "../Shared/Protocol.hpp"
+#include "LatencyTracker.hpp"
+#include "Predictor.hpp"
+#include "Scoreboard.hpp"
+#include "SnapshotInterpolator.hpp"
+#include "SpriteAtlas.hpp"
+#include "SpriteBatch.hpp"
+#include "SpscQueue.hpp"
+#include "TripleBuffer.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <chrono>
+#include <functional>
 #include <mutex>
+#include <optional>
 #include <vector>
 
 namespace Jetpack::Client {
+// A change of jetpack input, stamped when the render thread saw it.
+struct InputEdge {
+  bool jetpacking = false;
+  std::chrono::steady_clock::time_point time;
+};
+
+using InputQueue = SpscQueue<InputEdge, 256>;
+
+// The players of one GAME_STATE_UPDATE, with the predictor state as of the
+// last input sent, from which the local player is predicted every frame.
+struct PlayerSnapshot {
+  uint32_t step = 0;
+  std::chrono::steady_clock::time_point receivedAt;
+  std::vector<Shared::Protocol::Player> players;
+  Predictor predictor;
+};
 
+// Draws the game on the render thread. The update and handle methods are
+// called from the network thread: snapshots of players and entities are
+// handed over lock-free, and the rarer map and game events are queued and
+// applied at the start of the next frame.
 class GameDisplay {
 public:
   GameDisplay(int windowWidth = 1920, int windowHeight = 1080);
@@ -16,26 +47,59 @@ public:
   void run();
 
   void updateMap(const Shared::Protocol::GameMap &map);
-  void updateGameState(const std::vector<Shared::Protocol::Player> &players);
+  void updateGameState(const std::vector<Shared::Protocol::Player> &players,
+                       uint32_t step,
+                       std::chrono::steady_clock::time_point receivedAt,
+                       const Predictor &predictor);
+  void
+  updateEntities(const std::vector<Shared::Protocol::EntityState> &entities);
   void handleCoinCollected(int playerId, int x, int y);
   void handlePlayerDeath(int playerId);
   void handleGameOver(int winnerId);
 
   void setLocalPlayerId(int id);
   void setDebugMode(bool debug);
-
-  bool isJetpackActive() const;
+  void setLatencyTracker(LatencyTracker *tracker);
+  // How far in the past remote players are drawn.
+  void setInterpolationDelay(std::chrono::milliseconds delay);
+  // Every jetpack input edge is pushed to queue, then listener is called
+  // from the render thread to tell the consumer.
+  void setInputQueue(InputQueue *queue);
+  void setInputListener(std::function<void()> listener);
 
 private:
   sf::RenderWindow m_window;
 
   sf::Texture m_backgroundTexture;
-  sf::Texture m_playerSpritesheet;
-  sf::Texture m_coinSpritesheet;
-  sf::Texture m_zapperSpritesheet;
+  // Player, coin and zapper sheets; each layer of them is one draw call.
+  SpriteAtlas m_atlas;
+  SpriteBatch m_batch;
+
+  static constexpr int MAP_CHUNK_COLUMNS = 32;
+
+  // The tiles of MAP_CHUNK_COLUMNS map columns, positioned relative to the
+  // chunk, with one batch per animation frame so that animating only picks
+  // a different batch. Rebuilt when a coin in it is collected.
+  struct MapChunk {
+    std::vector<SpriteBatch> coins;
+    std::vector<SpriteBatch> zappers;
+    SpriteBatch outlines;
+    bool dirty = true;
+  };
+
+  std::vector<MapChunk> m_mapChunks;
+  // Cell width, cell height and top offset the chunks were built for.
+  sf::Vector3f m_mapChunkLayout;
 
   sf::Font m_gameFont;
 
+  // HUD text is laid out when it changes, not every frame.
+  Scoreboard m_scoreboard{m_gameFont};
+  sf::Text m_waitingText;
+  sf::RectangleShape m_gameOverOverlay;
+  sf::Text m_gameOverText;
+  sf::Text m_resultText;
+
   std::vector<sf::IntRect> m_playerRunFrames;
   std::vector<sf::IntRect> m_playerJetpackFrames;
   std::vector<sf::IntRect> m_coinFrames;
@@ -63,15 +127,35 @@ private:
 
   bool m_wasJetpacking = false;
   bool m_debugMode = false;
+  LatencyTracker *m_latencyTracker = nullptr;
+
+  struct DisplayEvent {
+    enum class Type { COIN, DEATH, GAME_OVER };
+
+    Type type;
+    int playerId;
+    int x;
+    int y;
+  };
+
+  TripleBuffer<PlayerSnapshot> m_playerSnapshots;
+  SnapshotInterpolator m_interpolator;
+  TripleBuffer<std::vector<Shared::Protocol::EntityState>> m_entitySnapshots;
+
+  std::mutex m_eventMutex;
+  std::optional<Shared::Protocol::GameMap> m_pendingMap;
+  std::vector<DisplayEvent> m_pendingEvents;
+  std::vector<DisplayEvent> m_events;
 
-  std::mutex m_dataMutex;
   Shared::Protocol::GameMap m_map;
-  std::vector<Shared::Protocol::Player> m_players;
   int m_localPlayerId = 1;
   bool m_gameOver = false;
   int m_winnerId = -1;
 
   bool m_jetpackActive = false;
+  bool m_queuedJetpackActive = false;
+  InputQueue *m_inputQueue = nullptr;
+  std::function<void()> m_inputListener;
 
   float m_topBoundary = 0.0f;
   float m_bottomBoundary = 0.0f;
@@ -81,17 +165,26 @@ private:
   void render();
   void drawBackground();
   void drawMap();
+  void buildMapChunk(int chunk);
+  void drawEntities();
   void drawPlayers();
   void drawUI();
   void drawGameOver();
+  void initializeHud();
+  void layoutResultText();
 
   void processEvents();
+  bool queueInputEdge();
+  void applyUpdates();
+  void predictLocalPlayer(std::chrono::steady_clock::time_point now);
+  void applyEvent(const DisplayEvent &event);
   void updateAnimations();
   void handleJetpackSounds();
 
   void loadResources();
   void loadSounds();
-  void initializeAnimations();
+  void initializeAnimations(sf::Vector2i playerOrigin, sf::Vector2i coinOrigin,
+                            sf::Vector2i zapperOrigin);
 
   std::vector<sf::Sprite> m_parallaxLayers;
   std::vector<float> m_parallaxSpeeds;
@@ -100,8 +193,16 @@ private:
   float m_visibleMapWidth = 0.0f;
   float m_cameraZoom = 2.0f;
 
+  static constexpr size_t MAX_PARALLAX_LAYERS = 4;
+
+  // Draws all layers with one shader pass when shaders are available;
+  // drawParallaxBackgrounds() falls back to one draw per repeated layer.
+  sf::Shader m_parallaxShader;
+  sf::VertexArray m_parallaxQuad;
+  bool m_parallaxShaderReady = false;
 
   void initializeParallaxBackgrounds();
+  void initializeParallaxShader();
   void updateParallaxBackgrounds(float deltaTime);
   void drawParallaxBackgrounds();
 };
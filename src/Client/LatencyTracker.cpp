@@ -0,0 +1,70 @@
+#include "LatencyTracker.hpp"
+#include "../Shared/PacketCodec.hpp"
+
+namespace {
+double toMilliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+} // namespace
+
+void Jetpack::Client::LatencyTracker::onPress() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stage = Stage::PRESSED;
+  m_pressTime = Clock::now();
+}
+
+void Jetpack::Client::LatencyTracker::onSend(uint16_t sequence) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_stage != Stage::PRESSED) {
+    return;
+  }
+
+  m_stage = Stage::SENT;
+  m_sequence = sequence;
+  m_sendTime = Clock::now();
+}
+
+void Jetpack::Client::LatencyTracker::onAck(uint16_t ackedSequence) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_stage != Stage::SENT ||
+      !Shared::PacketCodec::isSequenceAcked(ackedSequence, m_sequence)) {
+    return;
+  }
+
+  m_stage = Stage::ACKED;
+  m_ackTime = Clock::now();
+}
+
+void Jetpack::Client::LatencyTracker::onFrameBegin() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_stage == Stage::ACKED) {
+    m_stage = Stage::RENDERING;
+  }
+}
+
+void Jetpack::Client::LatencyTracker::onFrameDisplayed() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_stage != Stage::RENDERING) {
+    return;
+  }
+
+  const auto displayTime = Clock::now();
+  m_pressToSend.add(toMilliseconds(m_sendTime - m_pressTime));
+  m_sendToAck.add(toMilliseconds(m_ackTime - m_sendTime));
+  m_ackToDisplay.add(toMilliseconds(displayTime - m_ackTime));
+  m_pressToDisplay.add(toMilliseconds(displayTime - m_pressTime));
+  m_stage = Stage::IDLE;
+}
+
+void Jetpack::Client::LatencyTracker::report(std::ostream &out) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_pressToDisplay.empty()) {
+    return;
+  }
+
+  out << "Input latency over " << m_pressToDisplay.count() << " presses\n"
+      << "  press -> send:    " << m_pressToSend.summary() << "\n"
+      << "  send -> ack:      " << m_sendToAck.summary() << "\n"
+      << "  ack -> display:   " << m_ackToDisplay.summary() << "\n"
+      << "  press -> display: " << m_pressToDisplay.summary() << std::endl;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../Shared/LatencyStats.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+
+namespace Jetpack::Client {
+// Times one input edge at a time through the pipeline: the key press, the
+// PLAYER_INPUT_EDGE carrying it, the snapshot acknowledging its sequence
+// number (which includes the server tick that applied it) and the first
+// frame displayed with that snapshot. Called from the render and network
+// threads.
+class LatencyTracker {
+public:
+  void onPress();
+  void onSend(uint16_t sequence);
+  void onAck(uint16_t ackedSequence);
+  void onFrameBegin();
+  void onFrameDisplayed();
+
+  // Prints the percentiles of each stage over every press timed so far.
+  void report(std::ostream &out);
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Stage { IDLE, PRESSED, SENT, ACKED, RENDERING };
+
+  std::mutex m_mutex;
+  Stage m_stage = Stage::IDLE;
+  uint16_t m_sequence = 0;
+  Clock::time_point m_pressTime;
+  Clock::time_point m_sendTime;
+  Clock::time_point m_ackTime;
+
+  Shared::LatencyStats m_pressToSend;
+  Shared::LatencyStats m_sendToAck;
+  Shared::LatencyStats m_ackToDisplay;
+  Shared::LatencyStats m_pressToDisplay;
+};
+} // namespace Jetpack::Client
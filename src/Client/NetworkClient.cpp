@@ -1,21 +1,39 @@
 #include "NetworkClient.hpp"
 #include "../Shared/Exceptions.hpp"
+#include "../Shared/PacketCodec.hpp"
+#include "../Shared/Trace.hpp"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <iostream>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <utility>
 
 Jetpack::Client::NetworkClient::NetworkClient(const int serverPort,
                                               std::string serverAddress,
-                                              const bool debugMode)
+                                              const bool debugMode,
+                                              const std::string &packetLogFile,
+                                              const std::chrono::milliseconds
+                                                  interpolationDelay)
     : m_serverPort(serverPort), m_serverAddress(std::move(serverAddress)),
-      m_debugMode(debugMode) {}
+      m_debugMode(debugMode), m_interpolationDelay(interpolationDelay),
+      m_packetLogger(debugMode
+                         ? std::make_unique<Shared::PacketLogger>(packetLogFile)
+                         : nullptr) {
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0) {
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Failed to create wake event");
+  }
+}
 
 Jetpack::Client::NetworkClient::~NetworkClient() {
   m_running = false;
+  wakeNetworkThread();
   if (m_networkThread.joinable()) {
     m_networkThread.join();
   }
@@ -23,6 +41,7 @@ Jetpack::Client::NetworkClient::~NetworkClient() {
   if (m_serverSocket != -1) {
     ::close(m_serverSocket);
   }
+  ::close(m_wakeFd);
 }
 
 bool Jetpack::Client::NetworkClient::connectToServer() {
@@ -58,6 +77,10 @@ bool Jetpack::Client::NetworkClient::connectToServer() {
       static_cast<uint8_t>(Shared::Protocol::PacketType::CONNECT_REQUEST);
   buffer[1] = 0;
 
+  if (m_packetLogger) {
+    m_packetLogger->record(Shared::PacketLogger::Direction::OUTGOING,
+                           m_serverSocket, buffer, sizeof(buffer));
+  }
   if (::send(m_serverSocket, buffer, sizeof(buffer), 0) != sizeof(buffer)) {
     std::cerr << "Failed to send connection request" << std::endl;
     close(m_serverSocket);
@@ -70,6 +93,9 @@ bool Jetpack::Client::NetworkClient::connectToServer() {
 
 void Jetpack::Client::NetworkClient::start() {
   m_display = std::make_shared<GameDisplay>();
+  m_display->setInterpolationDelay(m_interpolationDelay);
+  m_display->setInputQueue(&m_inputQueue);
+  m_display->setInputListener([this] { wakeNetworkThread(); });
   m_networkThread = std::thread(&NetworkClient::networkLoop, this);
 
   while (m_localPlayerId == -1 && m_running) {
@@ -78,6 +104,7 @@ void Jetpack::Client::NetworkClient::start() {
 
   if (m_debugMode) {
     m_display->setDebugMode(true);
+    m_display->setLatencyTracker(&m_latencyTracker);
   }
 
   if (m_localPlayerId != -1) {
@@ -85,128 +112,140 @@ void Jetpack::Client::NetworkClient::start() {
   }
   m_display->run();
   m_running = false;
+  wakeNetworkThread();
   if (m_networkThread.joinable()) {
     m_networkThread.join();
   }
+
+  if (m_debugMode) {
+    m_latencyTracker.report(std::cout);
+  }
 }
 
 void Jetpack::Client::NetworkClient::networkLoop() {
-  constexpr int BUFFER_SIZE = 1024;
-  uint8_t recvBuffer[BUFFER_SIZE];
-  std::vector<uint8_t> accumulatedBuffer;
+  auto nextLatencyReport =
+      std::chrono::steady_clock::now() + LATENCY_REPORT_INTERVAL;
+  Shared::Trace::setThreadName("network");
 
-  const auto inputUpdateInterval = std::chrono::milliseconds(16);
-  auto lastInputUpdate = std::chrono::steady_clock::now();
+  pollfd pollfds[2] = {{m_serverSocket, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
 
   while (m_running) {
+    sendInputEdges();
+
     auto currentTime = std::chrono::steady_clock::now();
-    if (currentTime - lastInputUpdate >= inputUpdateInterval) {
-      sendPlayerInput();
-      lastInputUpdate = currentTime;
+    if (m_debugMode && currentTime >= nextLatencyReport) {
+      m_latencyTracker.report(std::cout);
+      nextLatencyReport = currentTime + LATENCY_REPORT_INTERVAL;
     }
 
-    ssize_t bytesRead = recv(m_serverSocket, recvBuffer, BUFFER_SIZE, 0);
-    if (bytesRead > 0) {
-      if (m_debugMode) {
-        std::cout << "Received " << bytesRead << " bytes: ";
-        for (ssize_t i = 0; i < bytesRead; i++) {
-          std::cout << std::hex << static_cast<int>(recvBuffer[i]) << " ";
-        }
-        std::cout << std::dec << std::endl;
-      }
+    // Sleep until data arrives or the render thread queues an input. Inputs
+    // are only sent when they change, so there is nothing else to wait for
+    // outside debug mode.
+    int timeout = -1;
+    if (m_debugMode) {
+      timeout = std::max<int>(
+          0, std::chrono::ceil<std::chrono::milliseconds>(
+                 nextLatencyReport - std::chrono::steady_clock::now())
+                 .count());
+    }
 
-      accumulatedBuffer.insert(accumulatedBuffer.end(), recvBuffer, recvBuffer + bytesRead);
-      size_t processedBytes = 0;
-      while (processedBytes < accumulatedBuffer.size()) {
-        size_t packetSize = getPacketSize(accumulatedBuffer.data() + processedBytes,
-                                          accumulatedBuffer.size() - processedBytes);
-        if (packetSize == 0) {
-          break;
-        }
-        processPacket(accumulatedBuffer.data() + processedBytes, packetSize);
-        processedBytes += packetSize;
+    const int ready = poll(pollfds, 2, timeout);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
       }
+      std::cerr << "Error polling server socket: " << strerror(errno)
+                << std::endl;
+      break;
+    }
 
-      if (processedBytes > 0) {
-        accumulatedBuffer.erase(accumulatedBuffer.begin(),
-                              accumulatedBuffer.begin() + processedBytes);
-      }
-    } else if (bytesRead < 0) {
-      if (errno != EAGAIN && errno != EWOULDBLOCK) {
-        std::cerr << "Error reading from server: " << strerror(errno)
-                  << std::endl;
-        break;
-      }
+    if (pollfds[1].revents & POLLIN) {
+      drainWakeEvents();
+    }
+    if (pollfds[0].revents & (POLLIN | POLLHUP | POLLERR) &&
+        !receiveData()) {
+      break;
     }
   }
 }
 
-size_t Jetpack::Client::NetworkClient::getPacketSize(const uint8_t *data,
-                                                     size_t maxSize) const {
-  if (maxSize < 1) {
-    return 0;
+bool Jetpack::Client::NetworkClient::receiveData() {
+  const ssize_t bytesRead = m_receiveBuffer.readFrom(m_serverSocket);
+  if (bytesRead == 0) {
+    std::cerr << "Server closed the connection" << std::endl;
+    return false;
   }
-
-  switch (Shared::Protocol::PacketType packetType =
-              static_cast<Shared::Protocol::PacketType>(data[0])) {
-  case Shared::Protocol::PacketType::CONNECT_RESPONSE:
-    return (maxSize >= 3) ? 3 : 0;
-
-  case Shared::Protocol::PacketType::MAP_DATA: {
-    if (maxSize < 5) {
-      return 0;
+  if (bytesRead < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      std::cerr << "Error reading from server: " << strerror(errno)
+                << std::endl;
+      return false;
     }
-    const int width = data[1] | (data[2] << 8);
-    const int height = data[3] | (data[4] << 8);
-    const size_t expectedSize = 5 + width * height;
-    return (maxSize >= expectedSize) ? expectedSize : 0;
+    return true;
   }
 
-  case Shared::Protocol::PacketType::GAME_START:
-    return (maxSize >= 3) ? 3 : 0;
-
-  case Shared::Protocol::PacketType::GAME_STATE_UPDATE: {
-    if (maxSize < 2) {
-      return 0;
+  TRACE_SCOPE("handleReceivedData");
+  if (m_packetLogger) {
+    const size_t offset = m_receiveBuffer.size() - bytesRead;
+    for (const auto &span : m_receiveBuffer.spans(offset, bytesRead)) {
+      if (!span.empty()) {
+        m_packetLogger->record(Shared::PacketLogger::Direction::INCOMING,
+                               m_serverSocket, span.data(), span.size());
+      }
     }
-    int playerCount = data[1];
-    constexpr size_t playerDataSize = 10;
-    size_t expectedSize = 2 + playerCount * playerDataSize;
-    return (maxSize >= expectedSize) ? expectedSize : 0;
   }
 
-  case Shared::Protocol::PacketType::COIN_COLLECTED:
-    return (maxSize >= 5) ? 5 : 0;
+  processReceivedPackets();
+  return true;
+}
 
-  case Shared::Protocol::PacketType::PLAYER_DEATH:
-    return (maxSize >= 2) ? 2 : 0;
+void Jetpack::Client::NetworkClient::processReceivedPackets() {
+  while (m_receiveBuffer.size() > 0) {
+    // Only the header is needed to frame a packet, so this stays cheap
+    // while a large MAP_DATA is still arriving.
+    const size_t headerSize =
+        std::min(m_receiveBuffer.size(), Shared::PacketCodec::MAX_HEADER_SIZE);
+    const size_t packetSize = getPacketSize(m_receiveBuffer.view(headerSize),
+                                            m_receiveBuffer.size());
+    if (packetSize == 0) {
+      break;
+    }
 
-  case Shared::Protocol::PacketType::GAME_OVER:
-    return (maxSize >= 3) ? 3 : 0;
+    processPacket(m_receiveBuffer.view(packetSize), packetSize);
+    m_receiveBuffer.consume(packetSize);
+  }
+}
 
-  case Shared::Protocol::PacketType::PLAYER_INPUT:
-    return (maxSize >= 2) ? 2 : 0;
+void Jetpack::Client::NetworkClient::wakeNetworkThread() const {
+  const uint64_t one = 1;
+  [[maybe_unused]] ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+}
 
-  default:
-    if (m_debugMode) {
-      std::cout << "Unknown packet type: " << static_cast<int>(packetType)
-                << std::endl;
-    }
+void Jetpack::Client::NetworkClient::drainWakeEvents() const {
+  uint64_t count;
+  [[maybe_unused]] ssize_t bytesRead = ::read(m_wakeFd, &count, sizeof(count));
+}
+
+size_t Jetpack::Client::NetworkClient::getPacketSize(const uint8_t *data,
+                                                     size_t maxSize) const {
+  if (maxSize < 1) {
     return 0;
   }
+
+  if (!Shared::PacketCodec::isKnownPacketType(data[0]) && m_debugMode) {
+    std::cout << "Unknown packet type: " << static_cast<int>(data[0])
+              << std::endl;
+  }
+  return Shared::PacketCodec::getPacketSize(data, maxSize);
 }
 
 void Jetpack::Client::NetworkClient::processPacket(const uint8_t *data,
                                                    size_t length) {
+  TRACE_SCOPE("processPacket");
   if (length < 1) {
     return;
   }
 
-  auto packetType = static_cast<Shared::Protocol::PacketType>(data[0]);
-  if (m_debugMode) {
-    std::cout << "Processing packet type: " << static_cast<int>(packetType)
-              << std::endl;
-  }
   switch (auto packetType =
               static_cast<Shared::Protocol::PacketType>(data[0])) {
   case Shared::Protocol::PacketType::CONNECT_RESPONSE:
@@ -230,6 +269,9 @@ void Jetpack::Client::NetworkClient::processPacket(const uint8_t *data,
   case Shared::Protocol::PacketType::GAME_OVER:
     handleGameOver(data, length);
     break;
+  case Shared::Protocol::PacketType::ENTITY_UPDATE:
+    handleEntityUpdate(data, length);
+    break;
   default:
     if (m_debugMode) {
       std::cout << "Unknown packet type: " << static_cast<int>(packetType)
@@ -270,7 +312,8 @@ void Jetpack::Client::NetworkClient::handleMapData(const uint8_t *data,
 
   m_map.width = width;
   m_map.height = height;
-  m_map.tiles.resize(height, std::vector<Shared::Protocol::TileType>(width));
+  m_map.tiles.resize(height,
+                     std::pmr::vector<Shared::Protocol::TileType>(width));
 
   for (int y = 0; y < height; y++) {
     for (int x = 0; x < width; x++) {
@@ -302,68 +345,44 @@ void Jetpack::Client::NetworkClient::handleGameStart(const uint8_t *data,
   }
 
   m_players.clear();
-  if (m_players.empty()) {
-    for (int i = 1; i <= playerCount; i++) {
-      m_players.emplace_back(-1, i);
-      m_players.back().setState(Shared::Protocol::PlayerState::PLAYING);
-    }
-    if (m_display) {
-      m_display->updateGameState(m_players);
-    }
+  m_predictor.reset();
+  for (int i = 1; i <= playerCount; i++) {
+    m_players.emplace_back(-1, i);
+    m_players.back().setState(Shared::Protocol::PlayerState::PLAYING);
   }
+  publishPlayers();
 }
 
 void Jetpack::Client::NetworkClient::handleGameStateUpdate(
     const uint8_t *data, const size_t length) {
-  if (length < 2) {
-    return;
-  }
-
-  const int playerCount = data[1];
-  constexpr size_t playerDataSize = 10;
-
-  if (length < 2 + playerCount * playerDataSize) {
+  if (!Shared::PacketCodec::decodeGameStateUpdate(data, length, m_players,
+                                                  &m_serverStep)) {
     return;
   }
+  m_serverStepTime = std::chrono::steady_clock::now();
+  m_hasServerStep = true;
 
-  for (int i = 0; i < playerCount; i++) {
-    const int offset = 2 + i * playerDataSize;
-    const int playerId = data[offset];
-    const auto state =
-        static_cast<Shared::Protocol::PlayerState>(data[offset + 1]);
-
-    const int16_t xFixedPrecision = data[offset + 2] | (data[offset + 3] << 8);
-    const int16_t yFixedPrecision = data[offset + 4] | (data[offset + 5] << 8);
-    const float x = xFixedPrecision / 100.0f;
-    const float y = yFixedPrecision / 100.0f;
-
-    const int score = data[offset + 6] | (data[offset + 7] << 8);
-    bool isJetpacking = data[offset + 8] != 0;
-
-    bool found = false;
-    for (auto &player : m_players) {
-      if (player.getId() == playerId) {
-        player.setState(state);
-        player.setPosition(x, y);
-        player.setScore(score);
-        player.setJetpacking(isJetpacking);
-        found = true;
-        break;
-      }
+  for (const auto &player : m_players) {
+    if (player.getId() != m_localPlayerId) {
+      continue;
     }
-
-    if (!found) {
-      m_players.emplace_back(-1, playerId);
-      m_players.back().setState(state);
-      m_players.back().setPosition(x, y);
-      m_players.back().setScore(score);
-      m_players.back().setJetpacking(isJetpacking);
+    m_predictor.onSnapshot(player, m_serverStep,
+                           estimateServerStep(m_serverStepTime), m_map);
+    if (m_debugMode) {
+      m_latencyTracker.onAck(player.getInputSequence());
     }
   }
 
-  if (m_display) {
-    m_display->updateGameState(m_players);
+  publishPlayers();
+}
+
+void Jetpack::Client::NetworkClient::publishPlayers() {
+  if (!m_display) {
+    return;
   }
+
+  m_display->updateGameState(m_players, m_serverStep, m_serverStepTime,
+                             m_predictor);
 }
 
 void Jetpack::Client::NetworkClient::handleCoinCollected(
@@ -426,18 +445,94 @@ void Jetpack::Client::NetworkClient::handleGameOver(const uint8_t *data,
   }
 }
 
-void Jetpack::Client::NetworkClient::sendPlayerInput() const {
-  if (m_serverSocket < 0 || !m_display) {
+void Jetpack::Client::NetworkClient::handleEntityUpdate(const uint8_t *data,
+                                                        const size_t length) {
+  if (length < Shared::Protocol::ENTITY_UPDATE_HEADER_SIZE) {
+    return;
+  }
+
+  const size_t entityCount = data[1] | (data[2] << 8);
+  if (length < Shared::Protocol::ENTITY_UPDATE_HEADER_SIZE +
+                   entityCount * Shared::Protocol::ENTITY_DATA_SIZE) {
     return;
   }
 
-  bool jetpackActive = m_display->isJetpackActive();
+  m_entities.resize(entityCount);
+  for (size_t i = 0; i < entityCount; i++) {
+    const size_t offset = Shared::Protocol::ENTITY_UPDATE_HEADER_SIZE +
+                          i * Shared::Protocol::ENTITY_DATA_SIZE;
+    auto &entity = m_entities[i];
 
-  uint8_t buffer[2];
-  buffer[0] = static_cast<uint8_t>(Shared::Protocol::PacketType::PLAYER_INPUT);
-  buffer[1] = jetpackActive ? 1 : 0;
+    entity.id = data[offset] | (data[offset + 1] << 8);
+    entity.type =
+        static_cast<Shared::Protocol::EntityType>(data[offset + 2] & 0x7F);
+    entity.active = (data[offset + 2] & 0x80) != 0;
+
+    const int32_t xFixedPrecision =
+        static_cast<int32_t>(data[offset + 3] | (data[offset + 4] << 8) |
+                             (data[offset + 5] << 16) |
+                             (static_cast<uint32_t>(data[offset + 6]) << 24));
+    const int16_t yFixedPrecision = data[offset + 7] | (data[offset + 8] << 8);
+    entity.position = {xFixedPrecision / 100.0f, yFixedPrecision / 100.0f};
+  }
+
+  if (m_display) {
+    m_display->updateEntities(m_entities);
+  }
+}
+
+void Jetpack::Client::NetworkClient::sendInputEdges() {
+  InputEdge edge;
+  while (m_inputQueue.pop(edge)) {
+    TRACE_SCOPE("sendInputEdge");
+    sendInputEdge(edge);
+  }
+}
+
+void Jetpack::Client::NetworkClient::sendInputEdge(const InputEdge &edge) {
+  if (m_serverSocket < 0) {
+    return;
+  }
+
+  const uint16_t sequence = ++m_inputSequence;
+  const uint32_t step = estimateServerStep(edge.time);
 
-  send(m_serverSocket, buffer, sizeof(buffer), 0);
+  uint8_t buffer[Shared::PacketCodec::PLAYER_INPUT_EDGE_SIZE];
+  buffer[0] =
+      static_cast<uint8_t>(Shared::Protocol::PacketType::PLAYER_INPUT_EDGE);
+  buffer[1] = edge.jetpacking ? 1 : 0;
+  buffer[2] = sequence & 0xFF;
+  buffer[3] = (sequence >> 8) & 0xFF;
+  buffer[4] = step & 0xFF;
+  buffer[5] = (step >> 8) & 0xFF;
+  buffer[6] = (step >> 16) & 0xFF;
+  buffer[7] = (step >> 24) & 0xFF;
+
+  sendPacket(buffer, sizeof(buffer));
+  if (m_debugMode) {
+    m_latencyTracker.onSend(sequence);
+  }
+
+  m_predictor.onInputSent(sequence, edge.jetpacking, step);
+  publishPlayers();
+}
+
+uint32_t Jetpack::Client::NetworkClient::estimateServerStep(
+    std::chrono::steady_clock::time_point time) const {
+  if (!m_hasServerStep) {
+    return 0;
+  }
+  return Predictor::estimateStep(m_serverStep, m_serverStepTime, time);
+}
+
+void Jetpack::Client::NetworkClient::sendPacket(const uint8_t *data,
+                                                size_t length) const {
+  send(m_serverSocket, data, length, 0);
+
+  if (m_packetLogger) {
+    m_packetLogger->record(Shared::PacketLogger::Direction::OUTGOING,
+                           m_serverSocket, data, length);
+  }
 }
 
 int Jetpack::Client::NetworkClient::getLocalPlayerId() const {
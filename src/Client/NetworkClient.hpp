@@ -1,19 +1,28 @@
 #pragma once
 
+#include "../Shared/PacketLogger.hpp"
 #include "../Shared/Protocol.hpp"
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <thread>
 #include <unistd.h>
 
 #include "GameDisplay.hpp"
+#include "LatencyTracker.hpp"
+#include "Predictor.hpp"
+#include "RingBuffer.hpp"
 
 namespace Jetpack::Client {
 class NetworkClient {
 public:
   explicit NetworkClient(int serverPort = 8080, std::string serverAddress = "",
-                         bool debugMode = false);
+                         bool debugMode = false,
+                         const std::string &packetLogFile =
+                             "jetpack_client.pktlog",
+                         std::chrono::milliseconds interpolationDelay =
+                             SnapshotInterpolator::DEFAULT_DELAY);
   ~NetworkClient();
 
   bool connectToServer();
@@ -22,9 +31,17 @@ public:
   int getLocalPlayerId() const;
 
 private:
+  static constexpr std::chrono::seconds LATENCY_REPORT_INTERVAL{10};
+
   void networkLoop();
+  bool receiveData();
+  // Wakes the network thread out of poll(), e.g. when the input changed or
+  // the client is shutting down.
+  void wakeNetworkThread() const;
+  void drainWakeEvents() const;
 
   size_t getPacketSize(const uint8_t *data, size_t maxSize) const;
+  void processReceivedPackets();
 
   void processPacket(const uint8_t *data, size_t length);
   void handleConnectResponse(const uint8_t *data, size_t length);
@@ -34,16 +51,38 @@ private:
   void handleCoinCollected(const uint8_t *data, size_t length) const;
   void handlePlayerDeath(const uint8_t *data, size_t length) const;
   void handleGameOver(const uint8_t *data, size_t length) const;
+  void handleEntityUpdate(const uint8_t *data, size_t length);
+
+  // Hands the players to the display with the predictor state, so that the
+  // render thread predicts the local player from the latest inputs.
+  void publishPlayers();
 
-  void sendPlayerInput() const;
+  void sendPacket(const uint8_t *data, size_t length) const;
+  void sendInputEdges();
+  void sendInputEdge(const InputEdge &edge);
+  // The server step an input seen at time should apply to, extrapolated
+  // from the last snapshot.
+  uint32_t estimateServerStep(std::chrono::steady_clock::time_point time) const;
   int m_serverPort;
   std::string m_serverAddress;
   bool m_debugMode = false;
+  std::chrono::milliseconds m_interpolationDelay;
+  std::unique_ptr<Shared::PacketLogger> m_packetLogger;
   int m_serverSocket = -1;
+  int m_wakeFd = -1;
+  RingBuffer m_receiveBuffer;
+  InputQueue m_inputQueue;
+  uint32_t m_serverStep = 0;
+  std::chrono::steady_clock::time_point m_serverStepTime;
+  bool m_hasServerStep = false;
   int m_localPlayerId = -1;
+  uint16_t m_inputSequence = 0;
+  LatencyTracker m_latencyTracker;
 
   Shared::Protocol::GameMap m_map;
   std::vector<Shared::Protocol::Player> m_players;
+  Predictor m_predictor;
+  std::vector<Shared::Protocol::EntityState> m_entities;
 
   std::atomic<bool> m_running{true};
   std::thread m_networkThread;
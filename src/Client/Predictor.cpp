@@ -0,0 +1,124 @@
+#include "Predictor.hpp"
+#include "../Shared/PacketCodec.hpp"
+#include "../Shared/Physics.hpp"
+#include <algorithm>
+#include <cmath>
+
+uint32_t Jetpack::Client::Predictor::estimateStep(
+    uint32_t serverStep, std::chrono::steady_clock::time_point serverStepTime,
+    std::chrono::steady_clock::time_point time) {
+  // Rounded down, so that an edge seen just before the snapshot arrived
+  // maps to the step the snapshot was taken at.
+  const auto elapsed = time - serverStepTime;
+  int64_t elapsedSteps = elapsed / Shared::Protocol::TICK_PERIOD;
+  if (elapsed < elapsedSteps * Shared::Protocol::TICK_PERIOD) {
+    elapsedSteps--;
+  }
+  return static_cast<uint32_t>(
+      std::max<int64_t>(0, int64_t{serverStep} + 1 + elapsedSteps));
+}
+
+void Jetpack::Client::Predictor::reset() {
+  m_pending.clear();
+  m_hasBase = false;
+  m_inputDelay = 0;
+  m_correction = {0, 0};
+}
+
+void Jetpack::Client::Predictor::onInputSent(uint16_t sequence,
+                                             bool jetpacking, uint32_t step) {
+  m_pending.push_back({sequence, jetpacking, step});
+}
+
+void Jetpack::Client::Predictor::onSnapshot(
+    const Shared::Protocol::Player &player, uint32_t serverStep,
+    uint32_t currentStep, const Shared::Protocol::GameMap &map) {
+  // An input first acknowledged by this snapshot was applied at its step.
+  while (!m_pending.empty() &&
+         Shared::PacketCodec::isSequenceAcked(player.getInputSequence(),
+                                              m_pending.front().sequence)) {
+    if (serverStep >= m_pending.front().step) {
+      m_inputDelay = std::min(serverStep - m_pending.front().step,
+                              MAX_PREDICTION_STEPS);
+    }
+    m_pending.pop_front();
+  }
+
+  const bool hadBase = m_hasBase;
+  const Shared::Protocol::Player before = simulate(currentStep, map);
+
+  m_base = player;
+  m_baseStep = serverStep;
+  m_hasBase = true;
+  if (!hadBase) {
+    return;
+  }
+
+  const Shared::Protocol::Player after = simulate(currentStep, map);
+  m_correction = correctionAt(currentStep);
+  m_correctionStep = currentStep;
+  m_correction.x += before.getPosition().x - after.getPosition().x;
+  m_correction.y += before.getPosition().y - after.getPosition().y;
+  if (std::hypot(m_correction.x, m_correction.y) > SNAP_DISTANCE) {
+    m_correction = {0, 0};
+  }
+}
+
+Jetpack::Shared::Protocol::Player Jetpack::Client::Predictor::predict(
+    uint32_t currentStep, const Shared::Protocol::GameMap &map) const {
+  Shared::Protocol::Player player = simulate(currentStep, map);
+  if (player.getState() != Shared::Protocol::PlayerState::PLAYING) {
+    return player;
+  }
+
+  const Shared::Protocol::Position correction = correctionAt(currentStep);
+  player.setPosition(player.getPosition().x + correction.x,
+                     player.getPosition().y + correction.y);
+  return player;
+}
+
+// Decays per step rather than per call, so that predicting every frame does
+// not make the correction fade faster on a faster display.
+Jetpack::Shared::Protocol::Position
+Jetpack::Client::Predictor::correctionAt(uint32_t currentStep) const {
+  if (currentStep <= m_correctionStep) {
+    return m_correction;
+  }
+  const float factor =
+      std::pow(CORRECTION_DECAY, static_cast<float>(currentStep -
+                                                    m_correctionStep));
+  return {m_correction.x * factor, m_correction.y * factor};
+}
+
+Jetpack::Shared::Protocol::Player Jetpack::Client::Predictor::simulate(
+    uint32_t currentStep, const Shared::Protocol::GameMap &map) const {
+  Shared::Protocol::Player player = m_base;
+  if (!m_hasBase ||
+      player.getState() != Shared::Protocol::PlayerState::PLAYING) {
+    return player;
+  }
+
+  // Inputs sent now apply m_inputDelay steps from now, so that is how far
+  // ahead the player is drawn.
+  const uint32_t targetStep =
+      std::min(currentStep + m_inputDelay, m_baseStep + MAX_PREDICTION_STEPS);
+
+  auto next = m_pending.begin();
+  uint32_t lastApplied = m_baseStep;
+  for (uint32_t step = m_baseStep + 1; step <= targetStep; step++) {
+    // Same spacing rule as the server: one input per step, in order.
+    if (next != m_pending.end() &&
+        std::max(next->step + m_inputDelay, lastApplied + 1) <= step) {
+      player.setJetpacking(next->jetpacking);
+      lastApplied = step;
+      ++next;
+    }
+
+    Shared::Physics::applyPhysics(player);
+    Shared::Physics::checkBounds(player, map);
+    if (player.getPosition().x >= map.width) {
+      break;
+    }
+  }
+  return player;
+}
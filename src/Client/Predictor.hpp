@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../Shared/Protocol.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace Jetpack::Client {
+// Predicts the local player from its own inputs so that a press shows up
+// right away instead of a round trip later. The prediction starts from the
+// last snapshot of the player and replays the inputs the server has not
+// acknowledged yet, each at the step it is expected to apply. It runs as far
+// ahead as inputs sent now take to apply. When a snapshot moves the
+// prediction, the jump is spread over the next few steps.
+// The network thread feeds it and hands copies to the render thread, which
+// predicts from its copy every frame.
+class Predictor {
+public:
+  // The server step an input seen at time should apply to, extrapolated
+  // from the step of the last snapshot and when it arrived.
+  static uint32_t
+  estimateStep(uint32_t serverStep,
+               std::chrono::steady_clock::time_point serverStepTime,
+               std::chrono::steady_clock::time_point time);
+
+  void reset();
+  bool hasSnapshot() const { return m_hasBase; }
+
+  void onInputSent(uint16_t sequence, bool jetpacking, uint32_t step);
+  // serverStep is the step the snapshot was taken at and currentStep the
+  // client's estimate of the step the server is about to simulate.
+  void onSnapshot(const Shared::Protocol::Player &player, uint32_t serverStep,
+                  uint32_t currentStep, const Shared::Protocol::GameMap &map);
+
+  // The player as it should be drawn now.
+  Shared::Protocol::Player predict(uint32_t currentStep,
+                                   const Shared::Protocol::GameMap &map) const;
+
+private:
+  static constexpr uint32_t MAX_PREDICTION_STEPS = 30;
+  static constexpr float CORRECTION_DECAY = 0.8f;
+  static constexpr float SNAP_DISTANCE = 1.5f;
+
+  struct PendingInput {
+    uint16_t sequence = 0;
+    bool jetpacking = false;
+    uint32_t step = 0;
+  };
+
+  Shared::Protocol::Player simulate(uint32_t currentStep,
+                                    const Shared::Protocol::GameMap &map) const;
+  // What is left at currentStep of the correction taken at m_correctionStep.
+  Shared::Protocol::Position correctionAt(uint32_t currentStep) const;
+
+  std::deque<PendingInput> m_pending;
+  Shared::Protocol::Player m_base{-1, -1};
+  uint32_t m_baseStep = 0;
+  bool m_hasBase = false;
+  // Steps between the step an input was sent for and the step the server
+  // applied it at, measured from acknowledgements.
+  uint32_t m_inputDelay = 0;
+  Shared::Protocol::Position m_correction = {0, 0};
+  uint32_t m_correctionStep = 0;
+};
+} // namespace Jetpack::Client
@@ -0,0 +1,70 @@
+#include "RingBuffer.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <sys/uio.h>
+
+Jetpack::Client::RingBuffer::RingBuffer(size_t capacity)
+    : m_buffer(std::bit_ceil(std::max<size_t>(capacity, 1))) {}
+
+ssize_t Jetpack::Client::RingBuffer::readFrom(int fd) {
+  if (capacity() - size() < MIN_READ_SPACE) {
+    grow(std::bit_ceil(size() + MIN_READ_SPACE));
+  }
+
+  const size_t offset = m_head & (capacity() - 1);
+  const size_t freeSpace = capacity() - size();
+  const size_t firstPart = std::min(freeSpace, capacity() - offset);
+
+  iovec iov[2] = {{m_buffer.data() + offset, firstPart},
+                  {m_buffer.data(), freeSpace - firstPart}};
+  const ssize_t bytesRead = readv(fd, iov, freeSpace > firstPart ? 2 : 1);
+  if (bytesRead > 0) {
+    m_head += bytesRead;
+  }
+  return bytesRead;
+}
+
+Jetpack::Client::RingBuffer::Spans
+Jetpack::Client::RingBuffer::spans(size_t offset, size_t length) const {
+  const size_t start = (m_tail + offset) & (capacity() - 1);
+  const size_t firstPart = std::min(length, capacity() - start);
+  return {std::span<const uint8_t>(m_buffer.data() + start, firstPart),
+          std::span<const uint8_t>(m_buffer.data(), length - firstPart)};
+}
+
+const uint8_t *Jetpack::Client::RingBuffer::view(size_t length) {
+  const auto [first, second] = spans(0, length);
+  if (second.empty()) {
+    return first.data();
+  }
+
+  m_scratch.resize(length);
+  std::memcpy(m_scratch.data(), first.data(), first.size());
+  std::memcpy(m_scratch.data() + first.size(), second.data(), second.size());
+  return m_scratch.data();
+}
+
+void Jetpack::Client::RingBuffer::consume(size_t length) {
+  m_tail += std::min(length, size());
+  // Restart at the front once empty so the next packets are less likely
+  // to wrap.
+  if (m_tail == m_head) {
+    m_head = 0;
+    m_tail = 0;
+  }
+}
+
+void Jetpack::Client::RingBuffer::grow(size_t capacity) {
+  std::vector<uint8_t> buffer(capacity);
+  const size_t length = size();
+  size_t copied = 0;
+  for (const auto &span : spans(0, length)) {
+    std::memcpy(buffer.data() + copied, span.data(), span.size());
+    copied += span.size();
+  }
+
+  m_buffer = std::move(buffer);
+  m_tail = 0;
+  m_head = length;
+}
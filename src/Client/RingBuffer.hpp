@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <sys/types.h>
+#include <vector>
+
+namespace Jetpack::Client {
+// Receive buffer for a byte stream. Reads land in the free space after the
+// unread bytes, wrapping around the end, and consumed bytes are dropped by
+// moving the read position, so nothing is ever shifted. The capacity is a
+// power of two and doubles when a read would not have room.
+class RingBuffer {
+public:
+  using Spans = std::array<std::span<const uint8_t>, 2>;
+
+  explicit RingBuffer(size_t capacity = DEFAULT_CAPACITY);
+
+  // One readv() of everything the socket has, up to the free space.
+  ssize_t readFrom(int fd);
+
+  size_t size() const { return m_head - m_tail; }
+  size_t capacity() const { return m_buffer.size(); }
+
+  // The bytes at [offset, offset + length) from the read position, split
+  // where they wrap; the second span is empty if they do not.
+  Spans spans(size_t offset, size_t length) const;
+
+  // A contiguous view of the first length unread bytes. Points into the
+  // ring unless they wrap, in which case they are copied to a scratch
+  // buffer that stays valid until the next call.
+  const uint8_t *view(size_t length);
+
+  void consume(size_t length);
+
+private:
+  static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+  static constexpr size_t MIN_READ_SPACE = 16 * 1024;
+
+  void grow(size_t capacity);
+
+  std::vector<uint8_t> m_buffer;
+  std::vector<uint8_t> m_scratch;
+  size_t m_head = 0;
+  size_t m_tail = 0;
+};
+} // namespace Jetpack::Client
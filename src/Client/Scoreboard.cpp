@@ -0,0 +1,100 @@
+#include "Scoreboard.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+Jetpack::Client::Scoreboard::Scoreboard(const sf::Font &font) : m_font(font) {}
+
+void Jetpack::Client::Scoreboard::update(
+    const std::vector<Shared::Protocol::Player> &players,
+    const int localPlayerId) {
+  if (m_lines.size() != players.size()) {
+    m_lines.resize(players.size());
+    m_dirty = true;
+  }
+
+  for (size_t i = 0; i < players.size(); i++) {
+    Line &line = m_lines[i];
+    const bool local = players[i].getId() == localPlayerId;
+    if (line.playerId == players[i].getId() &&
+        line.score == players[i].getScore() && line.local == local) {
+      continue;
+    }
+    line.playerId = players[i].getId();
+    line.score = players[i].getScore();
+    line.local = local;
+    layout(line);
+    m_dirty = true;
+  }
+}
+
+void Jetpack::Client::Scoreboard::layout(Line &line) const {
+  line.text.setFont(m_font);
+  line.text.setCharacterSize(CHARACTER_SIZE);
+  line.text.setOutlineThickness(OUTLINE_THICKNESS);
+  line.text.setOutlineColor(sf::Color::Black);
+
+  if (line.local) {
+    line.text.setString("You: " + std::to_string(line.score));
+    line.text.setFillColor(sf::Color::Green);
+  } else {
+    line.text.setString("Player " + std::to_string(line.playerId) + ": " +
+                        std::to_string(line.score));
+    line.text.setFillColor(sf::Color::Red);
+  }
+}
+
+void Jetpack::Client::Scoreboard::render() {
+  m_dirty = false;
+  if (m_lines.empty() || m_direct) {
+    return;
+  }
+
+  float width = 0.0f;
+  for (size_t i = 0; i < m_lines.size(); i++) {
+    m_lines[i].text.setPosition(PADDING, PADDING + i * LINE_HEIGHT);
+    width = std::max(width, m_lines[i].text.getLocalBounds().width);
+  }
+  const unsigned textureWidth =
+      static_cast<unsigned>(std::ceil(width + 2 * PADDING));
+  const unsigned textureHeight =
+      static_cast<unsigned>(std::ceil(m_lines.size() * LINE_HEIGHT + PADDING));
+
+  // Keep the texture while it is wide enough and exactly as tall.
+  const sf::Vector2u size = m_texture.getSize();
+  if (size.x < textureWidth || size.y != textureHeight) {
+    if (!m_texture.create(std::max(size.x, textureWidth), textureHeight)) {
+      std::cerr << "Failed to create the scoreboard texture!" << std::endl;
+      m_direct = true;
+      return;
+    }
+  }
+
+  m_texture.clear(sf::Color::Transparent);
+  for (const Line &line : m_lines) {
+    m_texture.draw(line.text);
+  }
+  m_texture.display();
+  m_sprite.setTexture(m_texture.getTexture(), true);
+}
+
+void Jetpack::Client::Scoreboard::draw(sf::RenderTarget &target,
+                                       const sf::Vector2f position) {
+  if (m_dirty) {
+    render();
+  }
+
+  if (m_direct) {
+    for (size_t i = 0; i < m_lines.size(); i++) {
+      m_lines[i].text.setPosition(position.x, position.y + i * LINE_HEIGHT);
+      target.draw(m_lines[i].text);
+    }
+    return;
+  }
+  if (m_lines.empty()) {
+    return;
+  }
+  m_sprite.setPosition(position.x - PADDING, position.y - PADDING);
+  target.draw(m_sprite);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../Shared/Protocol.hpp"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+namespace Jetpack::Client {
+// The score lines of the HUD. A line's text is laid out again only when its
+// player or score changes, and the lines are then rendered once into a
+// texture, so a frame draws the whole board as one sprite however many
+// players it lists.
+class Scoreboard {
+public:
+  explicit Scoreboard(const sf::Font &font);
+
+  void update(const std::vector<Shared::Protocol::Player> &players,
+              int localPlayerId);
+  void draw(sf::RenderTarget &target, sf::Vector2f position);
+
+private:
+  static constexpr unsigned CHARACTER_SIZE = 20;
+  static constexpr float LINE_HEIGHT = 30.0f;
+  static constexpr float OUTLINE_THICKNESS = 2.0f;
+  // Room left around the text for its outline.
+  static constexpr float PADDING = 4.0f;
+
+  struct Line {
+    int playerId = -1;
+    int score = -1;
+    bool local = false;
+    sf::Text text;
+  };
+
+  void layout(Line &line) const;
+  void render();
+
+  const sf::Font &m_font;
+  std::vector<Line> m_lines;
+  sf::RenderTexture m_texture;
+  sf::Sprite m_sprite;
+  bool m_dirty = false;
+  // Set when no render texture could be created: lines are drawn directly.
+  bool m_direct = false;
+};
+} // namespace Jetpack::Client
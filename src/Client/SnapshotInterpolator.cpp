@@ -0,0 +1,140 @@
+#include "SnapshotInterpolator.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+double tickSeconds() {
+  return std::chrono::duration<double>(Jetpack::Shared::Protocol::TICK_PERIOD)
+      .count();
+}
+} // namespace
+
+Jetpack::Client::SnapshotInterpolator::SnapshotInterpolator() {
+  setDelay(DEFAULT_DELAY);
+}
+
+void Jetpack::Client::SnapshotInterpolator::setDelay(
+    const std::chrono::milliseconds delay) {
+  m_delaySteps = std::chrono::duration<double>(delay).count() / tickSeconds();
+}
+
+void Jetpack::Client::SnapshotInterpolator::reset() {
+  m_histories.clear();
+  m_hasClock = false;
+  m_lastStep = 0;
+}
+
+void Jetpack::Client::SnapshotInterpolator::History::push(
+    const Sample &sample) {
+  samples[next] = sample;
+  next = (next + 1) % HISTORY_SIZE;
+  count = std::min(count + 1, HISTORY_SIZE);
+}
+
+const Jetpack::Client::SnapshotInterpolator::Sample &
+Jetpack::Client::SnapshotInterpolator::History::at(const size_t index) const {
+  return samples[(next + HISTORY_SIZE - count + index) % HISTORY_SIZE];
+}
+
+void Jetpack::Client::SnapshotInterpolator::addSnapshot(
+    const uint32_t step, const Clock::time_point receivedAt,
+    const std::vector<Shared::Protocol::Player> &players,
+    const int localPlayerId) {
+  if (m_hasClock && step + HISTORY_SIZE < m_lastStep) {
+    reset();
+  }
+  if (m_hasClock && step <= m_lastStep) {
+    return;
+  }
+  updateClock(step, receivedAt);
+  m_lastStep = step;
+
+  for (const auto &player : players) {
+    if (player.getId() != localPlayerId) {
+      m_histories[player.getId()].push({step, player.getPosition()});
+    }
+  }
+  std::erase_if(m_histories, [step](const auto &entry) {
+    return entry.second.at(entry.second.count - 1).step != step;
+  });
+}
+
+void Jetpack::Client::SnapshotInterpolator::updateClock(
+    const uint32_t step, const Clock::time_point receivedAt) {
+  const double offset =
+      std::chrono::duration<double>(receivedAt.time_since_epoch()).count() -
+      step * tickSeconds();
+
+  if (!m_hasClock || std::abs(offset - m_clockOffset) > RESYNC_SECONDS) {
+    m_clockOffset = offset;
+    m_hasClock = true;
+  } else if (offset < m_clockOffset) {
+    m_clockOffset = offset;
+  } else {
+    m_clockOffset += (offset - m_clockOffset) * CLOCK_DRIFT;
+  }
+}
+
+void Jetpack::Client::SnapshotInterpolator::apply(
+    const Clock::time_point now,
+    std::vector<Shared::Protocol::Player> &players,
+    const int localPlayerId) const {
+  if (!m_hasClock) {
+    return;
+  }
+  const double serverTime =
+      std::chrono::duration<double>(now.time_since_epoch()).count() -
+      m_clockOffset;
+  const double step = serverTime / tickSeconds() - m_delaySteps;
+
+  for (auto &player : players) {
+    if (player.getId() == localPlayerId) {
+      continue;
+    }
+    const auto it = m_histories.find(player.getId());
+    if (it == m_histories.end()) {
+      continue;
+    }
+    const Shared::Protocol::Position position = sample(it->second, step);
+    player.setPosition(position.x, position.y);
+  }
+}
+
+Jetpack::Shared::Protocol::Position
+Jetpack::Client::SnapshotInterpolator::sample(const History &history,
+                                              const double step) const {
+  const Sample &newest = history.at(history.count - 1);
+  if (step >= newest.step) {
+    if (history.count < 2) {
+      return newest.position;
+    }
+    const Sample &previous = history.at(history.count - 2);
+    const float ahead = static_cast<float>(
+        std::min(step - newest.step, MAX_EXTRAPOLATION_STEPS) /
+        (newest.step - previous.step));
+    const float dx = newest.position.x - previous.position.x;
+    const float dy = newest.position.y - previous.position.y;
+    if (std::abs(dx) + std::abs(dy) > TELEPORT_DISTANCE) {
+      return newest.position;
+    }
+    return {newest.position.x + dx * ahead, newest.position.y + dy * ahead};
+  }
+
+  for (size_t i = history.count - 1; i > 0; i--) {
+    const Sample &from = history.at(i - 1);
+    if (step < from.step) {
+      continue;
+    }
+    const Sample &to = history.at(i);
+    if (std::abs(to.position.x - from.position.x) +
+            std::abs(to.position.y - from.position.y) >
+        TELEPORT_DISTANCE) {
+      return step - from.step < to.step - step ? from.position : to.position;
+    }
+    const float t =
+        static_cast<float>((step - from.step) / (to.step - from.step));
+    return {from.position.x + (to.position.x - from.position.x) * t,
+            from.position.y + (to.position.y - from.position.y) * t};
+  }
+  return history.at(0).position;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../Shared/Protocol.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Jetpack::Client {
+// Draws remote players a fixed delay in the past, between the two snapshots
+// around that time, so that uneven packet arrival and a frame rate above the
+// tick rate do not show up as stutter. Snapshots are placed on the local
+// clock by their server step; the mapping follows the earliest arrivals,
+// which are the least delayed. When no newer snapshot has arrived, players
+// keep moving at their last velocity for a few steps, then stop.
+// Render thread only.
+class SnapshotInterpolator {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::milliseconds DEFAULT_DELAY{50};
+
+  SnapshotInterpolator();
+
+  void setDelay(std::chrono::milliseconds delay);
+  void reset();
+
+  // Records the remote players of the snapshot taken at step. Steps already
+  // seen are ignored, and a step far behind them starts over (a new match).
+  void addSnapshot(uint32_t step, Clock::time_point receivedAt,
+                   const std::vector<Shared::Protocol::Player> &players,
+                   int localPlayerId);
+
+  // Moves each remote player in players to where it was at now - delay.
+  void apply(Clock::time_point now,
+             std::vector<Shared::Protocol::Player> &players,
+             int localPlayerId) const;
+
+private:
+  static constexpr size_t HISTORY_SIZE = 16;
+  static constexpr double MAX_EXTRAPOLATION_STEPS = 6.0;
+  static constexpr float TELEPORT_DISTANCE = 2.0f;
+  // Offset changes beyond this are taken as a clock jump, not jitter.
+  static constexpr double RESYNC_SECONDS = 0.25;
+  // How fast the offset follows a latency increase, per snapshot.
+  static constexpr double CLOCK_DRIFT = 0.02;
+
+  struct Sample {
+    uint32_t step = 0;
+    Shared::Protocol::Position position = {0, 0};
+  };
+
+  // The last HISTORY_SIZE samples of one player, oldest first from next.
+  struct History {
+    std::array<Sample, HISTORY_SIZE> samples{};
+    size_t count = 0;
+    size_t next = 0;
+
+    void push(const Sample &sample);
+    const Sample &at(size_t index) const;
+  };
+
+  void updateClock(uint32_t step, Clock::time_point receivedAt);
+  Shared::Protocol::Position sample(const History &history,
+                                    double step) const;
+
+  std::unordered_map<int, History> m_histories;
+  double m_delaySteps = 0.0;
+  // Local arrival time minus server time of a snapshot, in seconds.
+  double m_clockOffset = 0.0;
+  bool m_hasClock = false;
+  uint32_t m_lastStep = 0;
+};
+} // namespace Jetpack::Client
@@ -0,0 +1,49 @@
+#include "SpriteAtlas.hpp"
+#include <algorithm>
+#include <iostream>
+
+Jetpack::Client::SpriteAtlas::SpriteAtlas() {
+  sf::Image white;
+  white.create(WHITE_SIZE, WHITE_SIZE, sf::Color::White);
+  const sf::Vector2i origin = place(white);
+  m_whiteTexel = {origin.x + WHITE_SIZE / 2.0f, origin.y + WHITE_SIZE / 2.0f};
+}
+
+sf::Vector2i Jetpack::Client::SpriteAtlas::add(const std::string &path) {
+  sf::Image image;
+  if (!image.loadFromFile(path)) {
+    std::cerr << "Failed to load " << path << "!" << std::endl;
+    return {0, 0};
+  }
+  return place(image);
+}
+
+sf::Vector2i Jetpack::Client::SpriteAtlas::place(const sf::Image &image) {
+  const sf::Vector2i origin(0, static_cast<int>(m_height));
+  m_entries.push_back({image, origin});
+  m_width = std::max(m_width, image.getSize().x);
+  m_height += image.getSize().y + PADDING;
+  return origin;
+}
+
+bool Jetpack::Client::SpriteAtlas::build() {
+  if (m_width > sf::Texture::getMaximumSize() ||
+      m_height > sf::Texture::getMaximumSize()) {
+    std::cerr << "Sprite atlas of " << m_width << "x" << m_height
+              << " exceeds the maximum texture size!" << std::endl;
+    return false;
+  }
+
+  sf::Image atlas;
+  atlas.create(m_width, m_height, sf::Color::Transparent);
+  for (const Entry &entry : m_entries) {
+    atlas.copy(entry.image, entry.origin.x, entry.origin.y);
+  }
+  m_entries.clear();
+
+  if (!m_texture.loadFromImage(atlas)) {
+    std::cerr << "Failed to upload the sprite atlas!" << std::endl;
+    return false;
+  }
+  return true;
+}
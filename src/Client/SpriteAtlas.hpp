@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+namespace Jetpack::Client {
+// Packs sprite sheets into one texture so that everything drawn from them
+// can share a single draw call. Sheets are stacked top to bottom with a gap
+// so that scaled sprites do not bleed into their neighbours. A small white
+// block is added for untextured quads.
+class SpriteAtlas {
+public:
+  SpriteAtlas();
+
+  // Adds the image at path and returns its top-left corner in the atlas.
+  // A missing image is reported and takes no space.
+  sf::Vector2i add(const std::string &path);
+  bool build();
+
+  const sf::Texture &getTexture() const { return m_texture; }
+  // A texel that is plain white, for solid colour quads.
+  sf::Vector2f getWhiteTexel() const { return m_whiteTexel; }
+
+private:
+  static constexpr unsigned PADDING = 2;
+  static constexpr unsigned WHITE_SIZE = 4;
+
+  sf::Vector2i place(const sf::Image &image);
+
+  struct Entry {
+    sf::Image image;
+    sf::Vector2i origin;
+  };
+
+  std::vector<Entry> m_entries;
+  unsigned m_width = 0;
+  unsigned m_height = 0;
+  sf::Vector2f m_whiteTexel;
+  sf::Texture m_texture;
+};
+} // namespace Jetpack::Client
@@ -0,0 +1,55 @@
+#include "SpriteBatch.hpp"
+
+void Jetpack::Client::SpriteBatch::add(const sf::FloatRect &target,
+                                       const sf::IntRect &source,
+                                       const sf::Color color) {
+  appendQuad(target, sf::FloatRect(source), color);
+}
+
+void Jetpack::Client::SpriteBatch::addSolid(const sf::FloatRect &target,
+                                            const sf::Vector2f texel,
+                                            const sf::Color color) {
+  appendQuad(target, {texel.x, texel.y, 0.0f, 0.0f}, color);
+}
+
+void Jetpack::Client::SpriteBatch::addOutline(const sf::FloatRect &target,
+                                              const sf::Vector2f texel,
+                                              const sf::Color color,
+                                              const float thickness) {
+  const float right = target.left + target.width - thickness;
+  const float bottom = target.top + target.height - thickness;
+
+  addSolid({target.left, target.top, target.width, thickness}, texel, color);
+  addSolid({target.left, bottom, target.width, thickness}, texel, color);
+  addSolid({target.left, target.top, thickness, target.height}, texel, color);
+  addSolid({right, target.top, thickness, target.height}, texel, color);
+}
+
+void Jetpack::Client::SpriteBatch::appendQuad(const sf::FloatRect &target,
+                                              const sf::FloatRect &source,
+                                              const sf::Color color) {
+  const float right = target.left + target.width;
+  const float bottom = target.top + target.height;
+  const float sourceRight = source.left + source.width;
+  const float sourceBottom = source.top + source.height;
+
+  m_vertices.append(sf::Vertex({target.left, target.top}, color,
+                               {source.left, source.top}));
+  m_vertices.append(
+      sf::Vertex({right, target.top}, color, {sourceRight, source.top}));
+  m_vertices.append(
+      sf::Vertex({right, bottom}, color, {sourceRight, sourceBottom}));
+  m_vertices.append(
+      sf::Vertex({target.left, bottom}, color, {source.left, sourceBottom}));
+}
+
+void Jetpack::Client::SpriteBatch::draw(
+    sf::RenderTarget &target, const sf::Texture &texture,
+    const sf::Transform &transform) const {
+  if (m_vertices.getVertexCount() == 0) {
+    return;
+  }
+  sf::RenderStates states(&texture);
+  states.transform = transform;
+  target.draw(m_vertices, states);
+}
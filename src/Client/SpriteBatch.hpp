@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+namespace Jetpack::Client {
+// Collects textured quads from one texture and draws them in a single call.
+// The vertex storage is kept between frames, so a frame that draws no more
+// than the previous ones does not allocate.
+class SpriteBatch {
+public:
+  void clear() { m_vertices.clear(); }
+
+  // Draws the texture area source stretched over target, tinted by color.
+  void add(const sf::FloatRect &target, const sf::IntRect &source,
+           sf::Color color = sf::Color::White);
+  // Fills target with color, using texel to read plain white.
+  void addSolid(const sf::FloatRect &target, sf::Vector2f texel,
+                sf::Color color);
+  // A rectangle outline of the given thickness drawn inside target.
+  void addOutline(const sf::FloatRect &target, sf::Vector2f texel,
+                  sf::Color color, float thickness = 1.0f);
+
+  void draw(sf::RenderTarget &target, const sf::Texture &texture,
+            const sf::Transform &transform = sf::Transform::Identity) const;
+
+private:
+  void appendQuad(const sf::FloatRect &target, const sf::FloatRect &source,
+                  sf::Color color);
+
+  sf::VertexArray m_vertices{sf::Quads};
+};
+} // namespace Jetpack::Client
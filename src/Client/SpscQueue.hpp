@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+namespace Jetpack::Client {
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. push() fails instead of blocking when the queue is full.
+template <typename T, size_t Capacity> class SpscQueue {
+  static_assert(std::has_single_bit(Capacity),
+                "SpscQueue capacity must be a power of two");
+
+public:
+  bool push(const T &value) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    m_slots[head & (Capacity - 1)] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &value) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) == tail) {
+      return false;
+    }
+    value = m_slots[tail & (Capacity - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::array<T, Capacity> m_slots{};
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+};
+} // namespace Jetpack::Client
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Jetpack::Client {
+// Hands the latest value from one writer thread to one reader thread
+// without locks. The writer fills back() and publishes it; the reader
+// calls update() to swap in the newest published value and then uses
+// front() until its next update(). Neither side ever waits, and values
+// published in between are simply skipped.
+template <typename T> class TripleBuffer {
+public:
+  T &back() { return m_slots[m_back]; }
+
+  void publish() {
+    m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) &
+             INDEX_MASK;
+  }
+
+  // Returns whether front() changed.
+  bool update() {
+    if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+      return false;
+    }
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) &
+              INDEX_MASK;
+    return true;
+  }
+
+  T &front() { return m_slots[m_front]; }
+  const T &front() const { return m_slots[m_front]; }
+
+private:
+  static constexpr uint8_t INDEX_MASK = 0x3;
+  static constexpr uint8_t FRESH = 0x4;
+
+  std::array<T, 3> m_slots{};
+  alignas(64) uint8_t m_back = 0;
+  alignas(64) std::atomic<uint8_t> m_middle{1};
+  alignas(64) uint8_t m_front = 2;
+};
+} // namespace Jetpack::Client
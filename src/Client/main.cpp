@@ -1,8 +1,10 @@
+#include "../Shared/Trace.hpp"
 #include "NetworkClient.hpp"
 #include <iostream>
 
 static void usage(char *program_name) {
-  std::cerr << "Usage: " << program_name << " -h <ip> -p <port> [-d]"
+  std::cerr << "Usage: " << program_name << " -h <ip> -p <port> [-d] [-l <packet log>]"
+            << " [-i <interpolation ms>] [--trace <file>]"
             << std::endl;
 }
 
@@ -10,6 +12,10 @@ int main(int argc, char *argv[]) {
   std::string serverIp = "127.0.0.1";
   int serverPort = 8080;
   bool debugMode = false;
+  std::string packetLogFile = "jetpack_client.pktlog";
+  std::string traceFile;
+  int interpolationMs =
+      Jetpack::Client::SnapshotInterpolator::DEFAULT_DELAY.count();
 
   for (int i = 1; i < argc; i++) {
     std::string arg = argv[i];
@@ -20,14 +26,32 @@ int main(int argc, char *argv[]) {
       serverPort = std::stoi(argv[++i]);
     } else if (arg == "-d") {
       debugMode = true;
+    } else if (arg == "-l" && i + 1 < argc) {
+      packetLogFile = argv[++i];
+    } else if (arg == "-i" && i + 1 < argc) {
+      interpolationMs = std::stoi(argv[++i]);
+    } else if (arg == "--trace" && i + 1 < argc) {
+      traceFile = argv[++i];
     } else {
       usage(argv[0]);
       return 1;
     }
   }
 
+  if (interpolationMs < 0) {
+    std::cerr << "Error: Interpolation delay must not be negative"
+              << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
   try {
-    Jetpack::Client::NetworkClient client(serverPort, serverIp, debugMode);
+    if (!traceFile.empty()) {
+      Jetpack::Shared::Trace::start(traceFile, "jetpack_client");
+    }
+    Jetpack::Client::NetworkClient client(
+        serverPort, serverIp, debugMode, packetLogFile,
+        std::chrono::milliseconds(interpolationMs));
 
     if (client.connectToServer()) {
       std::cout << "Connected to server at " << serverIp << ":" << serverPort
@@ -35,12 +59,15 @@ int main(int argc, char *argv[]) {
       client.start();
     } else {
       std::cerr << "Failed to connect to server" << std::endl;
+      Jetpack::Shared::Trace::stop();
       return 1;
     }
   } catch (const std::exception &e) {
     std::cerr << "Error: " << e.what() << std::endl;
+    Jetpack::Shared::Trace::stop();
     return 1;
   }
 
+  Jetpack::Shared::Trace::stop();
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,369 @@
+#include "LoadGenerator.hpp"
+#include "../Shared/Exceptions.hpp"
+#include "../Shared/PacketCodec.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+double toMilliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double toMegabytes(uint64_t bytes) { return bytes / (1024.0 * 1024.0); }
+} // namespace
+
+Jetpack::LoadGen::LoadGenerator::LoadGenerator(const LoadGenConfig &config)
+    : m_config(config), m_bots(config.clients),
+      m_recvBuffer(RECV_BUFFER_SIZE), m_random(config.seed) {
+  m_epollFd = epoll_create1(0);
+  if (m_epollFd < 0) {
+    throw Shared::Exceptions::SocketException(
+        std::string("Failed to create epoll instance: ") + strerror(errno));
+  }
+}
+
+Jetpack::LoadGen::LoadGenerator::~LoadGenerator() {
+  for (auto &bot : m_bots) {
+    if (bot.socket >= 0) {
+      ::close(bot.socket);
+    }
+  }
+  ::close(m_epollFd);
+}
+
+void Jetpack::LoadGen::LoadGenerator::run() {
+  const auto start = Clock::now();
+  const auto end = start + std::chrono::seconds(m_config.durationSeconds);
+  const auto connectInterval =
+      std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / m_config.connectRate));
+  const auto inputInterval =
+      std::chrono::milliseconds(m_config.inputIntervalMs);
+  const auto reportPeriod = std::chrono::seconds(1);
+
+  auto nextConnect = start;
+  auto nextInput = start + inputInterval;
+  auto nextReport = start + reportPeriod;
+  epoll_event events[MAX_EVENTS];
+
+  for (auto now = start; now < end; now = Clock::now()) {
+    while (m_opened < m_bots.size() && now >= nextConnect) {
+      openConnection(m_opened++);
+      nextConnect += connectInterval;
+    }
+
+    if (now >= nextInput) {
+      sendInputs();
+      nextInput = std::max(nextInput + inputInterval, now);
+    }
+
+    if (now >= nextReport) {
+      reportInterval(std::chrono::duration<double>(now - start).count());
+      nextReport += reportPeriod;
+    }
+
+    auto wakeup = std::min({nextInput, nextReport, end});
+    if (m_opened < m_bots.size()) {
+      wakeup = std::min(wakeup, nextConnect);
+    }
+    const int timeoutMs = std::max(
+        0, static_cast<int>(std::ceil(toMilliseconds(wakeup - Clock::now()))));
+
+    const int count = epoll_wait(m_epollFd, events, MAX_EVENTS, timeoutMs);
+    if (count < 0 && errno != EINTR) {
+      throw Shared::Exceptions::SocketException(
+          std::string("epoll_wait failed: ") + strerror(errno));
+    }
+    for (int i = 0; i < count; i++) {
+      handleEvent(events[i].data.u64, events[i].events);
+    }
+  }
+
+  reportSummary(std::chrono::duration<double>(Clock::now() - start).count());
+}
+
+void Jetpack::LoadGen::LoadGenerator::openConnection(size_t index) {
+  Bot &bot = m_bots[index];
+  bot = Bot{};
+  bot.connectStart = Clock::now();
+
+  bot.socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (bot.socket < 0) {
+    m_connectFailures++;
+    return;
+  }
+
+  int noDelay = 1;
+  setsockopt(bot.socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+  sockaddr_in serverAddr{};
+  serverAddr.sin_family = AF_INET;
+  serverAddr.sin_port = htons(m_config.port);
+  if (inet_pton(AF_INET, m_config.host.c_str(), &serverAddr.sin_addr) <= 0) {
+    throw Shared::Exceptions::SocketException("Invalid server address");
+  }
+
+  if (::connect(bot.socket, reinterpret_cast<sockaddr *>(&serverAddr),
+                sizeof(serverAddr)) < 0 &&
+      errno != EINPROGRESS) {
+    m_connectFailures++;
+    closeBot(bot);
+    return;
+  }
+
+  epoll_event event{};
+  event.events = EPOLLOUT;
+  event.data.u64 = index;
+  if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, bot.socket, &event) < 0) {
+    m_connectFailures++;
+    closeBot(bot);
+  }
+}
+
+void Jetpack::LoadGen::LoadGenerator::handleEvent(size_t index,
+                                                  uint32_t events) {
+  Bot &bot = m_bots[index];
+  if (bot.socket < 0) {
+    return;
+  }
+
+  if (!bot.connected) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    getsockopt(bot.socket, SOL_SOCKET, SO_ERROR, &error, &length);
+    if (error != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+      m_connectFailures++;
+      closeBot(bot);
+      return;
+    }
+    finishConnect(bot);
+    return;
+  }
+
+  if (events & EPOLLIN) {
+    handleReadable(bot);
+  }
+  if (bot.socket >= 0 && (events & (EPOLLERR | EPOLLHUP))) {
+    m_disconnects++;
+    closeBot(bot);
+  }
+
+  // The server closes every socket of a finished match: rejoin so the load
+  // stays at the requested client count.
+  if (bot.socket < 0) {
+    openConnection(index);
+  }
+}
+
+void Jetpack::LoadGen::LoadGenerator::finishConnect(Bot &bot) {
+  bot.connected = true;
+  m_connected++;
+  m_interval.connects++;
+  m_connectTimes.add(toMilliseconds(Clock::now() - bot.connectStart));
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = &bot - m_bots.data();
+  epoll_ctl(m_epollFd, EPOLL_CTL_MOD, bot.socket, &event);
+
+  const uint8_t request[2] = {
+      static_cast<uint8_t>(Shared::Protocol::PacketType::CONNECT_REQUEST), 0};
+  sendPacket(bot, request, sizeof(request));
+}
+
+void Jetpack::LoadGen::LoadGenerator::handleReadable(Bot &bot) {
+  while (true) {
+    const ssize_t bytesRead =
+        recv(bot.socket, m_recvBuffer.data(), m_recvBuffer.size(), 0);
+    if (bytesRead < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        m_disconnects++;
+        closeBot(bot);
+      }
+      break;
+    }
+    if (bytesRead == 0) {
+      m_disconnects++;
+      closeBot(bot);
+      break;
+    }
+
+    m_totalBytesIn += bytesRead;
+    m_interval.bytesIn += bytesRead;
+    bot.buffer.insert(bot.buffer.end(), m_recvBuffer.data(),
+                      m_recvBuffer.data() + bytesRead);
+  }
+
+  size_t processed = 0;
+  while (processed < bot.buffer.size()) {
+    const uint8_t *packet = bot.buffer.data() + processed;
+    const size_t available = bot.buffer.size() - processed;
+    const size_t packetSize =
+        Shared::PacketCodec::getPacketSize(packet, available);
+
+    if (packetSize == 0) {
+      // An unknown type cannot be framed, so nothing after it can be either.
+      if (!Shared::PacketCodec::isKnownPacketType(packet[0])) {
+        processed = bot.buffer.size();
+      }
+      break;
+    }
+    processPacket(bot, packet, packetSize);
+    processed += packetSize;
+  }
+  bot.buffer.erase(bot.buffer.begin(), bot.buffer.begin() + processed);
+}
+
+void Jetpack::LoadGen::LoadGenerator::processPacket(Bot &bot,
+                                                    const uint8_t *data,
+                                                    size_t length) {
+  switch (static_cast<Shared::Protocol::PacketType>(data[0])) {
+  case Shared::Protocol::PacketType::CONNECT_RESPONSE:
+    bot.playerId = data[1];
+    break;
+
+  case Shared::Protocol::PacketType::MAP_DATA:
+    bot.mapWidth = data[1] | (data[2] << 8);
+    bot.mapHeight = data[3] | (data[4] << 8);
+    break;
+
+  case Shared::Protocol::PacketType::GAME_STATE_UPDATE: {
+    if (!Shared::PacketCodec::decodeGameStateUpdate(data, length,
+                                                    bot.players)) {
+      break;
+    }
+    m_totalUpdates++;
+    m_interval.updates++;
+
+    if (!bot.awaitingAck) {
+      break;
+    }
+    for (const auto &player : bot.players) {
+      if (player.getId() == bot.playerId &&
+          Shared::PacketCodec::isSequenceAcked(player.getInputSequence(),
+                                               bot.timedSequence)) {
+        const double latency = toMilliseconds(Clock::now() - bot.timedSendTime);
+        m_latencies.add(latency);
+        m_interval.latencies.add(latency);
+        bot.awaitingAck = false;
+        break;
+      }
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+void Jetpack::LoadGen::LoadGenerator::sendInputs() {
+  const auto now = Clock::now();
+
+  for (size_t i = 0; i < m_bots.size(); i++) {
+    Bot &bot = m_bots[i];
+    if (!bot.connected || bot.playerId < 0) {
+      continue;
+    }
+
+    bool jetpacking = bot.jetpacking;
+    if (m_config.inputMode == InputMode::SCRIPTED) {
+      jetpacking = ((bot.inputCount + i) / SCRIPTED_HALF_PERIOD) % 2 == 0;
+    } else if (static_cast<int>(m_random() % 100) < RANDOM_FLIP_PERCENT) {
+      jetpacking = !jetpacking;
+    }
+    bot.inputCount++;
+    bot.jetpacking = jetpacking;
+    const uint16_t sequence = ++bot.inputSequence;
+
+    // One input per bot is timed at a time, and only while its match runs:
+    // waiting matches acknowledge inputs but broadcast no snapshots.
+    if (!bot.awaitingAck) {
+      bot.awaitingAck = std::any_of(
+          bot.players.begin(), bot.players.end(), [&bot](const auto &player) {
+            return player.getId() == bot.playerId &&
+                   player.getState() == Shared::Protocol::PlayerState::PLAYING;
+          });
+      bot.timedSequence = sequence;
+      bot.timedSendTime = now;
+    }
+
+    const uint8_t input[Shared::PacketCodec::PLAYER_INPUT_SIZE] = {
+        static_cast<uint8_t>(Shared::Protocol::PacketType::PLAYER_INPUT),
+        static_cast<uint8_t>(jetpacking ? 1 : 0),
+        static_cast<uint8_t>(sequence & 0xFF),
+        static_cast<uint8_t>((sequence >> 8) & 0xFF)};
+    sendPacket(bot, input, sizeof(input));
+  }
+}
+
+bool Jetpack::LoadGen::LoadGenerator::sendPacket(Bot &bot, const uint8_t *data,
+                                                 size_t length) {
+  const ssize_t bytesSent = send(bot.socket, data, length, MSG_NOSIGNAL);
+  if (bytesSent < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      m_droppedInputs++;
+    } else {
+      m_disconnects++;
+      closeBot(bot);
+    }
+    return false;
+  }
+
+  m_totalBytesOut += bytesSent;
+  m_interval.bytesOut += bytesSent;
+  return static_cast<size_t>(bytesSent) == length;
+}
+
+void Jetpack::LoadGen::LoadGenerator::closeBot(Bot &bot) {
+  if (bot.socket >= 0) {
+    ::close(bot.socket);
+    bot.socket = -1;
+  }
+  if (bot.connected) {
+    bot.connected = false;
+    m_connected--;
+  }
+}
+
+void Jetpack::LoadGen::LoadGenerator::reportInterval(double elapsedSeconds) {
+  std::cout << std::fixed << std::setprecision(1) << "[" << std::setw(5)
+            << elapsedSeconds << "s] clients " << m_connected << "/"
+            << m_bots.size() << "  connects/s " << m_interval.connects
+            << "  updates/s " << m_interval.updates << "  in "
+            << toMegabytes(m_interval.bytesIn) << " MiB/s  out "
+            << toMegabytes(m_interval.bytesOut) << " MiB/s  input->ack "
+            << m_interval.latencies.summary({0.50, 0.99}) << std::endl;
+
+  m_interval = IntervalStats{};
+}
+
+void Jetpack::LoadGen::LoadGenerator::reportSummary(
+    double elapsedSeconds) const {
+  const double seconds = std::max(elapsedSeconds, 1e-9);
+
+  std::cout << std::fixed << std::setprecision(2) << "\nSummary over "
+            << elapsedSeconds << "s\n"
+            << "  clients:     " << m_bots.size() << " requested, "
+            << m_connected << " connected at exit, " << m_connectFailures
+            << " failed connects, " << m_disconnects << " disconnects\n"
+            << "  connections: " << m_connectTimes.count() << " total, "
+            << m_connectTimes.count() / seconds << "/s, connect time "
+            << m_connectTimes.summary({0.50, 0.99}) << "\n"
+            << "  traffic:     in " << toMegabytes(m_totalBytesIn) / seconds
+            << " MiB/s (" << m_totalUpdates / seconds << " updates/s), out "
+            << toMegabytes(m_totalBytesOut) / seconds << " MiB/s, "
+            << m_droppedInputs << " inputs dropped\n"
+            << "  input->ack:  " << m_latencies.count() << " samples, "
+            << m_latencies.summary() << std::endl;
+}
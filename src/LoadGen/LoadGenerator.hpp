@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../Shared/LatencyStats.hpp"
+#include "../Shared/Protocol.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Jetpack::LoadGen {
+enum class InputMode { RANDOM, SCRIPTED };
+
+struct LoadGenConfig {
+  std::string host = "127.0.0.1";
+  int port = 8080;
+  int clients = 100;
+  double connectRate = 500.0;
+  int durationSeconds = 30;
+  int inputIntervalMs = 16;
+  InputMode inputMode = InputMode::RANDOM;
+  unsigned seed = 1;
+};
+
+// Simulates many headless players from one thread: every bot is a
+// non-blocking socket multiplexed through a single epoll instance.
+class LoadGenerator {
+public:
+  explicit LoadGenerator(const LoadGenConfig &config);
+  ~LoadGenerator();
+
+  LoadGenerator(const LoadGenerator &) = delete;
+  LoadGenerator &operator=(const LoadGenerator &) = delete;
+
+  void run();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int RANDOM_FLIP_PERCENT = 10;
+  static constexpr int SCRIPTED_HALF_PERIOD = 30;
+  static constexpr int MAX_EVENTS = 256;
+  static constexpr size_t RECV_BUFFER_SIZE = 64 * 1024;
+
+  struct Bot {
+    int socket = -1;
+    bool connected = false;
+    int playerId = -1;
+    int mapWidth = 0;
+    int mapHeight = 0;
+    Clock::time_point connectStart;
+
+    std::vector<uint8_t> buffer;
+    std::vector<Shared::Protocol::Player> players;
+
+    bool jetpacking = false;
+    uint16_t inputSequence = 0;
+    bool awaitingAck = false;
+    uint16_t timedSequence = 0;
+    Clock::time_point timedSendTime;
+    uint64_t inputCount = 0;
+  };
+
+  struct IntervalStats {
+    uint64_t connects = 0;
+    uint64_t updates = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    Shared::LatencyStats latencies;
+  };
+
+  void openConnection(size_t index);
+  void handleEvent(size_t index, uint32_t events);
+  void finishConnect(Bot &bot);
+  void handleReadable(Bot &bot);
+  void processPacket(Bot &bot, const uint8_t *data, size_t length);
+  void sendInputs();
+  bool sendPacket(Bot &bot, const uint8_t *data, size_t length);
+  void closeBot(Bot &bot);
+
+  void reportInterval(double elapsedSeconds);
+  void reportSummary(double elapsedSeconds) const;
+
+  LoadGenConfig m_config;
+  int m_epollFd = -1;
+  std::vector<Bot> m_bots;
+  std::vector<uint8_t> m_recvBuffer;
+  std::mt19937 m_random;
+
+  size_t m_opened = 0;
+  size_t m_connected = 0;
+  uint64_t m_connectFailures = 0;
+  uint64_t m_disconnects = 0;
+  uint64_t m_droppedInputs = 0;
+  uint64_t m_totalUpdates = 0;
+  uint64_t m_totalBytesIn = 0;
+  uint64_t m_totalBytesOut = 0;
+  Shared::LatencyStats m_connectTimes;
+  Shared::LatencyStats m_latencies;
+
+  IntervalStats m_interval;
+};
+} // namespace Jetpack::LoadGen
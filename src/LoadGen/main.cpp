@@ -0,0 +1,89 @@
+#include "LoadGenerator.hpp"
+#include <csignal>
+#include <iostream>
+#include <sys/resource.h>
+
+using Jetpack::LoadGen::InputMode;
+
+static void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name
+            << " -p <port> [-h <ip>] [-n <clients>] [-r <connects/s>]"
+               " [-d <seconds>] [-i <input interval ms>]"
+               " [-s random|scripted] [-S <seed>]"
+            << std::endl;
+}
+
+// Every simulated client holds a socket, so lift the soft descriptor limit.
+static void raiseDescriptorLimit() {
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  Jetpack::LoadGen::LoadGenConfig config;
+  config.port = 0;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-p" && i + 1 < argc) {
+      config.port = std::stoi(argv[++i]);
+    } else if (arg == "-h" && i + 1 < argc) {
+      config.host = argv[++i];
+    } else if (arg == "-n" && i + 1 < argc) {
+      config.clients = std::stoi(argv[++i]);
+    } else if (arg == "-r" && i + 1 < argc) {
+      config.connectRate = std::stod(argv[++i]);
+    } else if (arg == "-d" && i + 1 < argc) {
+      config.durationSeconds = std::stoi(argv[++i]);
+    } else if (arg == "-i" && i + 1 < argc) {
+      config.inputIntervalMs = std::stoi(argv[++i]);
+    } else if (arg == "-s" && i + 1 < argc) {
+      std::string mode = argv[++i];
+      if (mode == "random") {
+        config.inputMode = InputMode::RANDOM;
+      } else if (mode == "scripted") {
+        config.inputMode = InputMode::SCRIPTED;
+      } else {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "-S" && i + 1 < argc) {
+      config.seed = std::stoul(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.port <= 0 || config.port > 65535) {
+    std::cerr << "Error: Invalid port number" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+  if (config.clients <= 0 || config.connectRate <= 0.0 ||
+      config.durationSeconds <= 0 || config.inputIntervalMs <= 0) {
+    std::cerr << "Error: Client count, rate, duration and interval must be "
+                 "positive"
+              << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::signal(SIGPIPE, SIG_IGN);
+  raiseDescriptorLimit();
+
+  try {
+    Jetpack::LoadGen::LoadGenerator generator(config);
+    generator.run();
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
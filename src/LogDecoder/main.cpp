@@ -0,0 +1,211 @@
+#include "../Shared/PacketCodec.hpp"
+#include "../Shared/PacketLogger.hpp"
+#include "../Shared/Protocol.hpp"
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Jetpack::Shared::PacketCodec;
+using Jetpack::Shared::PacketLogger;
+using Jetpack::Shared::Protocol::PacketType;
+
+static void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name << " <packet log> [-x]" << std::endl;
+}
+
+static const char *getPacketName(PacketType type) {
+  switch (type) {
+  case PacketType::CONNECT_REQUEST:
+    return "CONNECT_REQUEST";
+  case PacketType::CONNECT_RESPONSE:
+    return "CONNECT_RESPONSE";
+  case PacketType::MAP_DATA:
+    return "MAP_DATA";
+  case PacketType::GAME_START:
+    return "GAME_START";
+  case PacketType::PLAYER_INPUT:
+    return "PLAYER_INPUT";
+  case PacketType::PLAYER_INPUT_EDGE:
+    return "PLAYER_INPUT_EDGE";
+  case PacketType::GAME_STATE_UPDATE:
+    return "GAME_STATE_UPDATE";
+  case PacketType::PLAYER_POSITION:
+    return "PLAYER_POSITION";
+  case PacketType::COIN_COLLECTED:
+    return "COIN_COLLECTED";
+  case PacketType::PLAYER_DEATH:
+    return "PLAYER_DEATH";
+  case PacketType::GAME_OVER:
+    return "GAME_OVER";
+  case PacketType::PLAYER_DISCONNECT:
+    return "PLAYER_DISCONNECT";
+  case PacketType::ENTITY_UPDATE:
+    return "ENTITY_UPDATE";
+  }
+  return "UNKNOWN";
+}
+
+static std::string formatHex(const uint8_t *data, size_t length) {
+  std::ostringstream out;
+  out << std::hex << std::uppercase << std::setfill('0');
+  for (size_t i = 0; i < length; i++) {
+    out << std::setw(2) << static_cast<int>(data[i]) << ' ';
+  }
+  return out.str();
+}
+
+static std::string describePacket(const uint8_t *data, size_t length) {
+  std::ostringstream out;
+
+  switch (static_cast<PacketType>(data[0])) {
+  case PacketType::PLAYER_INPUT:
+    out << "jetpack=" << (data[1] ? "on" : "off")
+        << " seq=" << (data[2] | (data[3] << 8));
+    break;
+  case PacketType::PLAYER_INPUT_EDGE:
+    out << "jetpack=" << (data[1] ? "on" : "off")
+        << " seq=" << (data[2] | (data[3] << 8)) << " step="
+        << (data[4] | (data[5] << 8) | (data[6] << 16) |
+            (static_cast<uint32_t>(data[7]) << 24));
+    break;
+  case PacketType::CONNECT_RESPONSE:
+    out << "player=" << static_cast<int>(data[1])
+        << " players=" << static_cast<int>(data[2]);
+    break;
+  case PacketType::MAP_DATA:
+    out << (data[1] | (data[2] << 8)) << "x" << (data[3] | (data[4] << 8));
+    break;
+  case PacketType::GAME_START:
+    out << "players=" << static_cast<int>(data[1]);
+    break;
+  case PacketType::GAME_STATE_UPDATE:
+    out << "step="
+        << (data[2] | (data[3] << 8) | (data[4] << 16) |
+            (static_cast<uint32_t>(data[5]) << 24))
+        << " ";
+    for (size_t offset = PacketCodec::GAME_STATE_HEADER_SIZE;
+         offset + PacketCodec::PLAYER_STATE_SIZE <= length;
+         offset += PacketCodec::PLAYER_STATE_SIZE) {
+      const int16_t x = data[offset + 2] | (data[offset + 3] << 8);
+      const int16_t y = data[offset + 4] | (data[offset + 5] << 8);
+      out << "[p" << static_cast<int>(data[offset])
+          << " state=" << static_cast<int>(data[offset + 1])
+          << " pos=" << x / 100.0f << "," << y / 100.0f << " vy="
+          << PacketCodec::decodeVelocity(static_cast<int8_t>(data[offset + 9]))
+          << " score=" << (data[offset + 6] | (data[offset + 7] << 8))
+          << " ack=" << (data[offset + 10] | (data[offset + 11] << 8))
+          << (data[offset + 8] ? " jet" : "") << "] ";
+    }
+    break;
+  case PacketType::COIN_COLLECTED:
+    out << "player=" << static_cast<int>(data[1]) << " at "
+        << static_cast<int>(data[2]) << "," << static_cast<int>(data[3])
+        << " score=" << static_cast<int>(data[4]);
+    break;
+  case PacketType::PLAYER_DEATH:
+    out << "player=" << static_cast<int>(data[1]);
+    break;
+  case PacketType::GAME_OVER:
+    if (data[1]) {
+      out << "winner=" << static_cast<int>(data[2]);
+    } else {
+      out << "no winner";
+    }
+    break;
+  case PacketType::ENTITY_UPDATE:
+    out << "entities=" << (data[1] | (data[2] << 8));
+    break;
+  default:
+    break;
+  }
+  return out.str();
+}
+
+int main(int argc, char *argv[]) {
+  std::string path;
+  bool showHex = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-x") {
+      showHex = true;
+    } else if (path.empty()) {
+      path = arg;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (path.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(PacketLogger::FILE_MAGIC)];
+  if (!file.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, PacketLogger::FILE_MAGIC, sizeof(magic)) != 0) {
+    std::cerr << "Error: " << path << " is not a packet log" << std::endl;
+    return 1;
+  }
+
+  // recv() and send() do not preserve packet boundaries, so bytes are
+  // reassembled per socket and direction before decoding.
+  std::map<std::pair<int, PacketLogger::Direction>, std::vector<uint8_t>>
+      streams;
+  uint64_t firstTimestamp = 0;
+  PacketLogger::RecordHeader header;
+
+  std::cout << std::fixed << std::setprecision(3);
+  while (file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    std::vector<uint8_t> payload(header.length);
+    if (!file.read(reinterpret_cast<char *>(payload.data()), header.length)) {
+      std::cerr << "Warning: truncated record at end of log" << std::endl;
+      break;
+    }
+    if (firstTimestamp == 0) {
+      firstTimestamp = header.timestampNs;
+    }
+
+    auto &stream = streams[{header.socket, header.direction}];
+    stream.insert(stream.end(), payload.begin(), payload.end());
+
+    size_t processed = 0;
+    while (processed < stream.size()) {
+      const uint8_t *packet = stream.data() + processed;
+      size_t size =
+          PacketCodec::getPacketSize(packet, stream.size() - processed);
+      if (size == 0 && PacketCodec::isKnownPacketType(packet[0])) {
+        break;
+      }
+      if (size == 0) {
+        size = stream.size() - processed;
+      }
+
+      std::cout << std::setw(12)
+                << (header.timestampNs - firstTimestamp) / 1e6 << " ms "
+                << (header.direction == PacketLogger::Direction::INCOMING
+                        ? "<- "
+                        : "-> ")
+                << "socket " << header.socket << " "
+                << getPacketName(static_cast<PacketType>(packet[0])) << " ("
+                << size << " bytes) " << describePacket(packet, size);
+      if (showHex) {
+        std::cout << std::endl << "    " << formatHex(packet, size);
+      }
+      std::cout << std::endl;
+      processed += size;
+    }
+    stream.erase(stream.begin(), stream.begin() + processed);
+  }
+
+  return 0;
+}
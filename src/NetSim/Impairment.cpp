@@ -0,0 +1,107 @@
+#include "Impairment.hpp"
+#include "../Shared/Exceptions.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+void Jetpack::NetSim::applySettings(const std::string &settings,
+                                    Impairment &impairment) {
+  std::istringstream input(settings);
+  std::string setting;
+
+  while (input >> setting) {
+    const size_t separator = setting.find('=');
+    if (separator == std::string::npos) {
+      throw Shared::Exceptions::NetSimException("Expected key=value, got " +
+                                                setting);
+    }
+
+    const std::string key = setting.substr(0, separator);
+    double value = 0.0;
+    try {
+      value = std::stod(setting.substr(separator + 1));
+    } catch (const std::exception &) {
+      throw Shared::Exceptions::NetSimException("Invalid value in " + setting);
+    }
+    if (value < 0.0) {
+      throw Shared::Exceptions::NetSimException("Negative value in " +
+                                                setting);
+    }
+
+    if (key == "delay") {
+      impairment.delayMs = value;
+    } else if (key == "jitter") {
+      impairment.jitterMs = value;
+    } else if (key == "rate") {
+      impairment.rateKbps = value;
+    } else if (key == "loss") {
+      impairment.lossPercent = std::min(value, 100.0);
+    } else if (key == "reorder") {
+      impairment.reorderPercent = std::min(value, 100.0);
+    } else {
+      throw Shared::Exceptions::NetSimException("Unknown setting " + key);
+    }
+  }
+}
+
+std::string Jetpack::NetSim::describe(const Impairment &impairment) {
+  std::ostringstream out;
+  out << "delay=" << impairment.delayMs << "ms jitter=" << impairment.jitterMs
+      << "ms rate=";
+  if (impairment.rateKbps > 0.0) {
+    out << impairment.rateKbps << "kbit/s";
+  } else {
+    out << "unlimited";
+  }
+  out << " loss=" << impairment.lossPercent
+      << "% reorder=" << impairment.reorderPercent << "%";
+  return out.str();
+}
+
+std::vector<Jetpack::NetSim::ScheduleEntry>
+Jetpack::NetSim::loadSchedule(const std::string &path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw Shared::Exceptions::NetSimException("Failed to open " + path);
+  }
+
+  std::vector<ScheduleEntry> schedule;
+  std::string line;
+  int lineNumber = 0;
+
+  while (std::getline(file, line)) {
+    lineNumber++;
+    line = line.substr(0, line.find('#'));
+
+    std::istringstream input(line);
+    ScheduleEntry entry;
+    std::string direction;
+    if (!(input >> entry.timeSeconds)) {
+      if (line.find_first_not_of(" \t\r") == std::string::npos) {
+        continue;
+      }
+      throw Shared::Exceptions::NetSimException(
+          path + ":" + std::to_string(lineNumber) + ": expected a time");
+    }
+    input >> direction;
+    entry.up = direction == "up" || direction == "both";
+    entry.down = direction == "down" || direction == "both";
+    if (!entry.up && !entry.down) {
+      throw Shared::Exceptions::NetSimException(
+          path + ":" + std::to_string(lineNumber) +
+          ": direction must be up, down or both");
+    }
+    std::getline(input, entry.settings);
+
+    // Validate now rather than when the entry fires mid-run.
+    Impairment scratch;
+    applySettings(entry.settings, scratch);
+    schedule.push_back(entry);
+  }
+
+  std::stable_sort(schedule.begin(), schedule.end(),
+                   [](const ScheduleEntry &a, const ScheduleEntry &b) {
+                     return a.timeSeconds < b.timeSeconds;
+                   });
+  return schedule;
+}
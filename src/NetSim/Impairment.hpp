@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Jetpack::NetSim {
+// Network conditions applied to one direction of the proxied traffic.
+struct Impairment {
+  double delayMs = 0.0;
+  double jitterMs = 0.0;
+  double rateKbps = 0.0;
+  double lossPercent = 0.0;
+  double reorderPercent = 0.0;
+};
+
+// Changes the impairments of one or both directions at a point in time.
+struct ScheduleEntry {
+  double timeSeconds = 0.0;
+  bool up = false;
+  bool down = false;
+  std::string settings;
+};
+
+// Applies whitespace-separated key=value settings (delay, jitter, rate,
+// loss, reorder) on top of impairment.
+void applySettings(const std::string &settings, Impairment &impairment);
+
+std::string describe(const Impairment &impairment);
+
+// Reads "<seconds> up|down|both key=value..." lines; '#' starts a comment.
+std::vector<ScheduleEntry> loadSchedule(const std::string &path);
+} // namespace Jetpack::NetSim
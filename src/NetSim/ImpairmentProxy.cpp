@@ -0,0 +1,394 @@
+#include "ImpairmentProxy.hpp"
+#include "../Shared/Exceptions.hpp"
+#include "../Shared/PacketCodec.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+std::atomic<bool> Jetpack::NetSim::ImpairmentProxy::s_running{true};
+
+namespace {
+constexpr uint64_t LISTEN_KEY = UINT64_MAX;
+
+// Each connection registers its client socket as id * 2 and its server
+// socket as id * 2 + 1.
+uint64_t makeKey(uint64_t id, bool serverSide) {
+  return id * 2 + (serverSide ? 1 : 0);
+}
+} // namespace
+
+Jetpack::NetSim::ImpairmentProxy::ImpairmentProxy(const ProxyConfig &config)
+    : m_config(config), m_recvBuffer(RECV_BUFFER_SIZE),
+      m_random(config.seed) {
+  m_epollFd = epoll_create1(0);
+  if (m_epollFd < 0) {
+    throw Shared::Exceptions::SocketException(
+        std::string("Failed to create epoll instance: ") + strerror(errno));
+  }
+  initializeListener();
+}
+
+Jetpack::NetSim::ImpairmentProxy::~ImpairmentProxy() {
+  for (const auto &[_, connection] : m_connections) {
+    ::close(connection->up.from);
+    ::close(connection->up.to);
+  }
+  if (m_listenSocket >= 0) {
+    ::close(m_listenSocket);
+  }
+  ::close(m_epollFd);
+}
+
+void Jetpack::NetSim::ImpairmentProxy::initializeListener() {
+  m_listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (m_listenSocket < 0) {
+    throw Shared::Exceptions::SocketException("Failed to create socket");
+  }
+
+  int opt = 1;
+  setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = INADDR_ANY;
+  address.sin_port = htons(m_config.listenPort);
+
+  if (bind(m_listenSocket, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(m_listenSocket, SOMAXCONN) < 0) {
+    throw Shared::Exceptions::SocketException(
+        "Failed to listen on port " + std::to_string(m_config.listenPort));
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = LISTEN_KEY;
+  epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenSocket, &event);
+}
+
+void Jetpack::NetSim::ImpairmentProxy::run() {
+  const auto start = Clock::now();
+  auto nextStats = start + STATS_INTERVAL;
+  epoll_event events[MAX_EVENTS];
+
+  std::cout << "Relaying port " << m_config.listenPort << " to "
+            << m_config.serverHost << ":" << m_config.serverPort << "\n"
+            << "  up:   " << describe(m_config.up) << "\n"
+            << "  down: " << describe(m_config.down) << std::endl;
+
+  while (s_running) {
+    auto now = Clock::now();
+    applySchedule(std::chrono::duration<double>(now - start).count());
+
+    std::vector<uint64_t> closed;
+    for (auto &[id, connection] : m_connections) {
+      if (!deliverDue(connection->up, now) ||
+          !deliverDue(connection->down, now)) {
+        closed.push_back(id);
+        continue;
+      }
+      updateWriteInterest(*connection);
+    }
+    for (uint64_t id : closed) {
+      closeConnection(id);
+    }
+
+    if (now >= nextStats) {
+      printStats();
+      nextStats += STATS_INTERVAL;
+    }
+
+    const auto wakeup = std::min(nextWakeup(now), nextStats);
+    const int timeoutMs = static_cast<int>(
+        std::chrono::ceil<std::chrono::milliseconds>(wakeup - Clock::now())
+            .count());
+
+    const int count =
+        epoll_wait(m_epollFd, events, MAX_EVENTS, std::max(0, timeoutMs));
+    if (count < 0 && errno != EINTR) {
+      throw Shared::Exceptions::SocketException(
+          std::string("epoll_wait failed: ") + strerror(errno));
+    }
+    for (int i = 0; i < count; i++) {
+      handleEvent(events[i].data.u64, events[i].events);
+    }
+  }
+
+  printStats();
+}
+
+void Jetpack::NetSim::ImpairmentProxy::acceptClients() {
+  int clientSocket;
+  while ((clientSocket = accept4(m_listenSocket, nullptr, nullptr,
+                                 SOCK_NONBLOCK)) >= 0) {
+    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(m_config.serverPort);
+
+    if (serverSocket < 0 ||
+        inet_pton(AF_INET, m_config.serverHost.c_str(),
+                  &serverAddr.sin_addr) <= 0 ||
+        ::connect(serverSocket, reinterpret_cast<sockaddr *>(&serverAddr),
+                  sizeof(serverAddr)) < 0) {
+      std::cerr << "Failed to connect to " << m_config.serverHost << ":"
+                << m_config.serverPort << ": " << strerror(errno) << std::endl;
+      if (serverSocket >= 0) {
+        ::close(serverSocket);
+      }
+      ::close(clientSocket);
+      continue;
+    }
+
+    int flags = fcntl(serverSocket, F_GETFL, 0);
+    fcntl(serverSocket, F_SETFL, flags | O_NONBLOCK);
+    int noDelay = 1;
+    setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay,
+               sizeof(noDelay));
+    setsockopt(serverSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay,
+               sizeof(noDelay));
+
+    auto connection = std::make_unique<Connection>();
+    connection->id = m_nextConnectionId++;
+    connection->up.from = clientSocket;
+    connection->up.to = serverSocket;
+    connection->up.upstream = true;
+    connection->down.from = serverSocket;
+    connection->down.to = clientSocket;
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = makeKey(connection->id, false);
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, clientSocket, &event);
+    event.data.u64 = makeKey(connection->id, true);
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, serverSocket, &event);
+
+    m_connections.emplace(connection->id, std::move(connection));
+  }
+}
+
+void Jetpack::NetSim::ImpairmentProxy::handleEvent(uint64_t key,
+                                                   uint32_t events) {
+  if (key == LISTEN_KEY) {
+    acceptClients();
+    return;
+  }
+
+  auto it = m_connections.find(key / 2);
+  if (it == m_connections.end()) {
+    return;
+  }
+  Connection &connection = *it->second;
+  const bool serverSide = key % 2 == 1;
+
+  // Reading a socket feeds the link leaving it; writing drains the link
+  // arriving at it.
+  Link &incoming = serverSide ? connection.down : connection.up;
+  Link &outgoing = serverSide ? connection.up : connection.down;
+
+  bool open = true;
+  if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+    open = readLink(incoming);
+  }
+  if (open && (events & EPOLLOUT)) {
+    open = flush(outgoing);
+  }
+
+  if (!open) {
+    closeConnection(connection.id);
+    return;
+  }
+  updateWriteInterest(connection);
+}
+
+bool Jetpack::NetSim::ImpairmentProxy::readLink(Link &link) {
+  while (true) {
+    const ssize_t bytesRead =
+        recv(link.from, m_recvBuffer.data(), m_recvBuffer.size(), 0);
+    if (bytesRead == 0) {
+      return false;
+    }
+    if (bytesRead < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      return false;
+    }
+    link.inbound.insert(link.inbound.end(), m_recvBuffer.data(),
+                        m_recvBuffer.data() + bytesRead);
+  }
+
+  size_t processed = 0;
+  while (processed < link.inbound.size()) {
+    const uint8_t *packet = link.inbound.data() + processed;
+    const size_t available = link.inbound.size() - processed;
+    size_t packetSize = Shared::PacketCodec::getPacketSize(packet, available);
+
+    if (packetSize == 0) {
+      // Bytes that cannot be framed are relayed as one unit, untouched.
+      if (Shared::PacketCodec::isKnownPacketType(packet[0])) {
+        break;
+      }
+      packetSize = available;
+    }
+    schedulePacket(link, packet, packetSize);
+    processed += packetSize;
+  }
+  link.inbound.erase(link.inbound.begin(), link.inbound.begin() + processed);
+  return true;
+}
+
+void Jetpack::NetSim::ImpairmentProxy::schedulePacket(Link &link,
+                                                      const uint8_t *data,
+                                                      size_t length) {
+  const Impairment &impairment = link.upstream ? m_config.up : m_config.down;
+  DirectionStats &stats = link.upstream ? m_upStats : m_downStats;
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const auto now = Clock::now();
+  stats.packets++;
+  stats.bytes += length;
+
+  // The packet first waits for the link to finish serializing earlier
+  // packets, then propagates.
+  auto departAt = now;
+  if (impairment.rateKbps > 0.0) {
+    departAt = std::max(now, link.linkFreeAt) +
+               std::chrono::duration_cast<Clock::duration>(
+                   std::chrono::duration<double>(length * 8.0 /
+                                                 (impairment.rateKbps * 1000)));
+    link.linkFreeAt = departAt;
+  }
+
+  const double jitterMs = impairment.jitterMs * (2.0 * unit(m_random) - 1.0);
+  const double delayMs = std::max(0.0, impairment.delayMs + jitterMs);
+  auto deliverAt = departAt + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double, std::milli>(
+                                      delayMs));
+
+  if (unit(m_random) * 100.0 < impairment.lossPercent) {
+    stats.lost++;
+    if (m_config.lossMode == LossMode::DATAGRAM) {
+      return;
+    }
+    deliverAt += RETRANSMISSION_TIMEOUT;
+  }
+
+  if (m_config.lossMode == LossMode::TCP) {
+    // The stream is delivered in order, so a late packet blocks the rest.
+    deliverAt = std::max(deliverAt, link.lastDeliverAt);
+    link.lastDeliverAt = deliverAt;
+  } else if (unit(m_random) * 100.0 < impairment.reorderPercent) {
+    stats.reordered++;
+    deliverAt += REORDER_HOLD;
+  }
+
+  link.queue.push({deliverAt, link.nextOrder++,
+                   std::vector<uint8_t>(data, data + length)});
+}
+
+bool Jetpack::NetSim::ImpairmentProxy::deliverDue(Link &link,
+                                                  Clock::time_point now) {
+  bool moved = false;
+  while (!link.queue.empty() && link.queue.top().deliverAt <= now) {
+    const auto &data = link.queue.top().data;
+    link.outbound.insert(link.outbound.end(), data.begin(), data.end());
+    link.queue.pop();
+    moved = true;
+  }
+  return !moved || flush(link);
+}
+
+bool Jetpack::NetSim::ImpairmentProxy::flush(Link &link) {
+  if (link.outbound.empty()) {
+    return true;
+  }
+
+  const ssize_t sent = send(link.to, link.outbound.data(),
+                            link.outbound.size(), MSG_NOSIGNAL);
+  if (sent < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+  link.outbound.erase(link.outbound.begin(), link.outbound.begin() + sent);
+  return true;
+}
+
+void Jetpack::NetSim::ImpairmentProxy::updateWriteInterest(
+    Connection &connection) {
+  for (Link *link : {&connection.up, &connection.down}) {
+    const bool waiting = !link->outbound.empty();
+    if (waiting == link->waitingWritable) {
+      continue;
+    }
+
+    epoll_event event{};
+    event.events = waiting ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.u64 = makeKey(connection.id, link->upstream);
+    epoll_ctl(m_epollFd, EPOLL_CTL_MOD, link->to, &event);
+    link->waitingWritable = waiting;
+  }
+}
+
+void Jetpack::NetSim::ImpairmentProxy::closeConnection(uint64_t id) {
+  auto it = m_connections.find(id);
+  if (it == m_connections.end()) {
+    return;
+  }
+
+  ::close(it->second->up.from);
+  ::close(it->second->up.to);
+  m_connections.erase(it);
+}
+
+void Jetpack::NetSim::ImpairmentProxy::applySchedule(double elapsedSeconds) {
+  while (m_nextScheduleEntry < m_config.schedule.size() &&
+         m_config.schedule[m_nextScheduleEntry].timeSeconds <=
+             elapsedSeconds) {
+    const ScheduleEntry &entry = m_config.schedule[m_nextScheduleEntry++];
+    if (entry.up) {
+      applySettings(entry.settings, m_config.up);
+    }
+    if (entry.down) {
+      applySettings(entry.settings, m_config.down);
+    }
+
+    std::cout << "[" << entry.timeSeconds << "s] up:   "
+              << describe(m_config.up) << "\n[" << entry.timeSeconds
+              << "s] down: " << describe(m_config.down) << std::endl;
+  }
+}
+
+Jetpack::NetSim::ImpairmentProxy::Clock::time_point
+Jetpack::NetSim::ImpairmentProxy::nextWakeup(Clock::time_point now) const {
+  auto wakeup = now + std::chrono::milliseconds(100);
+
+  for (const auto &[_, connection] : m_connections) {
+    if (!connection->up.queue.empty()) {
+      wakeup = std::min(wakeup, connection->up.queue.top().deliverAt);
+    }
+    if (!connection->down.queue.empty()) {
+      wakeup = std::min(wakeup, connection->down.queue.top().deliverAt);
+    }
+  }
+  return wakeup;
+}
+
+void Jetpack::NetSim::ImpairmentProxy::printStats() const {
+  auto print = [](const char *name, const DirectionStats &stats) {
+    std::cout << "  " << name << stats.packets << " packets, " << stats.bytes
+              << " bytes, " << stats.lost << " lost, " << stats.reordered
+              << " reordered\n";
+  };
+
+  std::cout << m_connections.size() << " connection(s)\n";
+  print("up:   ", m_upStats);
+  print("down: ", m_downStats);
+  std::cout << std::flush;
+}
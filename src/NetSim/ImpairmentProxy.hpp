@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Impairment.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Jetpack::NetSim {
+// TCP: a lost packet is delivered after a retransmission timeout and holds
+// back everything behind it. DATAGRAM: it is dropped and packets may be
+// reordered, as an unreliable transport would behave.
+enum class LossMode { TCP, DATAGRAM };
+
+struct ProxyConfig {
+  int listenPort = 0;
+  std::string serverHost = "127.0.0.1";
+  int serverPort = 0;
+  Impairment up;
+  Impairment down;
+  std::vector<ScheduleEntry> schedule;
+  LossMode lossMode = LossMode::TCP;
+  unsigned seed = 1;
+};
+
+// Relays game connections between clients and the server, splitting the
+// byte streams into protocol packets and delaying, throttling, losing or
+// reordering each one according to the impairment of its direction.
+class ImpairmentProxy {
+public:
+  explicit ImpairmentProxy(const ProxyConfig &config);
+  ~ImpairmentProxy();
+
+  ImpairmentProxy(const ImpairmentProxy &) = delete;
+  ImpairmentProxy &operator=(const ImpairmentProxy &) = delete;
+
+  // Relays traffic until stop() is called, e.g. from a signal handler.
+  void run();
+  static void stop() { s_running = false; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr auto RETRANSMISSION_TIMEOUT = std::chrono::milliseconds(200);
+  static constexpr auto REORDER_HOLD = std::chrono::milliseconds(20);
+  static constexpr auto STATS_INTERVAL = std::chrono::seconds(5);
+  static constexpr int MAX_EVENTS = 64;
+  static constexpr size_t RECV_BUFFER_SIZE = 64 * 1024;
+
+  struct ScheduledPacket {
+    Clock::time_point deliverAt;
+    uint64_t order = 0;
+    std::vector<uint8_t> data;
+
+    bool operator>(const ScheduledPacket &other) const {
+      return deliverAt != other.deliverAt ? deliverAt > other.deliverAt
+                                          : order > other.order;
+    }
+  };
+
+  struct DirectionStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t lost = 0;
+    uint64_t reordered = 0;
+  };
+
+  // One direction of a relayed connection.
+  struct Link {
+    int from = -1;
+    int to = -1;
+    bool upstream = false;
+    std::vector<uint8_t> inbound;
+    std::priority_queue<ScheduledPacket, std::vector<ScheduledPacket>,
+                        std::greater<>>
+        queue;
+    std::vector<uint8_t> outbound;
+    bool waitingWritable = false;
+    Clock::time_point linkFreeAt;
+    Clock::time_point lastDeliverAt;
+    uint64_t nextOrder = 0;
+  };
+
+  struct Connection {
+    uint64_t id = 0;
+    Link up;
+    Link down;
+  };
+
+  void initializeListener();
+  void acceptClients();
+  void handleEvent(uint64_t key, uint32_t events);
+  bool readLink(Link &link);
+  void schedulePacket(Link &link, const uint8_t *data, size_t length);
+  bool deliverDue(Link &link, Clock::time_point now);
+  bool flush(Link &link);
+  void updateWriteInterest(Connection &connection);
+  void closeConnection(uint64_t id);
+
+  void applySchedule(double elapsedSeconds);
+  Clock::time_point nextWakeup(Clock::time_point now) const;
+  void printStats() const;
+
+  static std::atomic<bool> s_running;
+
+  ProxyConfig m_config;
+  int m_listenSocket = -1;
+  int m_epollFd = -1;
+  uint64_t m_nextConnectionId = 0;
+  std::unordered_map<uint64_t, std::unique_ptr<Connection>> m_connections;
+  size_t m_nextScheduleEntry = 0;
+  std::vector<uint8_t> m_recvBuffer;
+  std::mt19937 m_random;
+  DirectionStats m_upStats;
+  DirectionStats m_downStats;
+};
+} // namespace Jetpack::NetSim
@@ -0,0 +1,84 @@
+#include "../Shared/Exceptions.hpp"
+#include "ImpairmentProxy.hpp"
+#include <csignal>
+#include <iostream>
+
+using Jetpack::NetSim::LossMode;
+
+static void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name
+            << " -l <listen port> -p <server port> [-h <server ip>]"
+               " [-u <up settings>] [-w <down settings>] [-b <settings>]"
+               " [-S <schedule>] [-m tcp|datagram] [--seed <n>]\n"
+               "Settings: \"delay=<ms> jitter=<ms> rate=<kbit/s>"
+               " loss=<%> reorder=<%>\""
+            << std::endl;
+}
+
+static void handleSignal(int) { Jetpack::NetSim::ImpairmentProxy::stop(); }
+
+int main(int argc, char *argv[]) {
+  Jetpack::NetSim::ProxyConfig config;
+
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+
+      if (arg == "-l" && i + 1 < argc) {
+        config.listenPort = std::stoi(argv[++i]);
+      } else if (arg == "-p" && i + 1 < argc) {
+        config.serverPort = std::stoi(argv[++i]);
+      } else if (arg == "-h" && i + 1 < argc) {
+        config.serverHost = argv[++i];
+      } else if (arg == "-u" && i + 1 < argc) {
+        Jetpack::NetSim::applySettings(argv[++i], config.up);
+      } else if (arg == "-w" && i + 1 < argc) {
+        Jetpack::NetSim::applySettings(argv[++i], config.down);
+      } else if (arg == "-b" && i + 1 < argc) {
+        Jetpack::NetSim::applySettings(argv[i + 1], config.up);
+        Jetpack::NetSim::applySettings(argv[++i], config.down);
+      } else if (arg == "-S" && i + 1 < argc) {
+        config.schedule = Jetpack::NetSim::loadSchedule(argv[++i]);
+      } else if (arg == "-m" && i + 1 < argc) {
+        std::string mode = argv[++i];
+        if (mode == "tcp") {
+          config.lossMode = LossMode::TCP;
+        } else if (mode == "datagram") {
+          config.lossMode = LossMode::DATAGRAM;
+        } else {
+          usage(argv[0]);
+          return 1;
+        }
+      } else if (arg == "--seed" && i + 1 < argc) {
+        config.seed = std::stoul(argv[++i]);
+      } else {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  } catch (const Jetpack::Shared::Exceptions::Exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (config.listenPort <= 0 || config.listenPort > 65535 ||
+      config.serverPort <= 0 || config.serverPort > 65535) {
+    std::cerr << "Error: Invalid port number" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::signal(SIGPIPE, SIG_IGN);
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+
+  try {
+    Jetpack::NetSim::ImpairmentProxy proxy(config);
+    proxy.run();
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
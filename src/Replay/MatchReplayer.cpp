@@ -0,0 +1,91 @@
+#include "MatchReplayer.hpp"
+#include <chrono>
+#include <memory_resource>
+#include <thread>
+
+bool Jetpack::Replay::ReplayResult::matches(
+    const Server::MatchRecording &recording) const {
+  return steps == recording.getSteps() &&
+         winnerId == recording.getWinnerId() &&
+         results == recording.getResults();
+}
+
+Jetpack::Replay::MatchReplayer::MatchReplayer(
+    const Server::MatchRecording &recording)
+    : m_recording(recording) {
+  m_config.playersPerMatch = recording.getPlayersPerMatch();
+}
+
+Jetpack::Replay::ReplayResult
+Jetpack::Replay::MatchReplayer::run(double speed, std::ostream *progress) {
+  Server::MatchServices services;
+  services.offline = true;
+  Server::Match match(std::pmr::new_delete_resource(),
+                      m_recording.getMapTemplate(), m_config, services,
+                      m_recording.getMatchId());
+
+  const auto &events = m_recording.getEvents();
+  const auto start = std::chrono::steady_clock::now();
+  auto nextStep = start;
+  size_t next = 0;
+
+  while (true) {
+    // Events recorded after the match ended share its last step, so they
+    // are applied before checking for the end.
+    while (next < events.size() && events[next].step <= match.getStep()) {
+      applyEvent(match, events[next++]);
+    }
+    if (match.getGameState() != Shared::Protocol::GameState::IN_PROGRESS) {
+      break;
+    }
+
+    if (speed > 0.0) {
+      nextStep += std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Server::Match::TICK_PERIOD / speed);
+      std::this_thread::sleep_until(nextStep);
+    }
+    match.updateGameState();
+
+    if (progress && match.getStep() % PROGRESS_INTERVAL_STEPS == 0) {
+      printProgress(match, *progress);
+    }
+  }
+
+  ReplayResult result;
+  result.steps = match.getStep();
+  result.winnerId = match.getWinnerId();
+  result.results = Server::MatchRecording::collectResults(match);
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
+
+void Jetpack::Replay::MatchReplayer::applyEvent(
+    Server::Match &match, const Server::MatchRecording::Event &event) const {
+  switch (event.type) {
+  case Server::MatchRecording::EventType::JOIN:
+    match.addPlayer(event.key);
+    match.checkGameStart();
+    break;
+  case Server::MatchRecording::EventType::LEAVE:
+    match.removePlayer(event.key);
+    break;
+  case Server::MatchRecording::EventType::INPUT:
+    match.setPlayerInput(event.key, event.value != 0, 0);
+    break;
+  case Server::MatchRecording::EventType::END:
+    match.forceEnd();
+    break;
+  }
+}
+
+void Jetpack::Replay::MatchReplayer::printProgress(
+    const Server::Match &match, std::ostream &output) const {
+  output << "step " << match.getStep() << ":";
+  for (const auto &result : Server::MatchRecording::collectResults(match)) {
+    output << "  p" << result.id << " x=" << result.x << " y=" << result.y
+           << " score=" << result.score;
+  }
+  output << std::endl;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../Server/Match.hpp"
+#include "../Server/MatchRecording.hpp"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace Jetpack::Replay {
+struct ReplayResult {
+  uint32_t steps = 0;
+  int winnerId = -1;
+  std::vector<Server::MatchRecording::PlayerResult> results;
+  double seconds = 0.0;
+
+  bool matches(const Server::MatchRecording &recording) const;
+};
+
+// Re-simulates a recorded match offline by feeding its joins, leaves and
+// inputs back to a fresh Match at the steps they were recorded before.
+class MatchReplayer {
+public:
+  explicit MatchReplayer(const Server::MatchRecording &recording);
+
+  // speed scales the server tick rate; 0 runs as fast as possible. When
+  // progress is set, player positions are printed once per second of play.
+  ReplayResult run(double speed, std::ostream *progress);
+
+private:
+  static constexpr uint32_t PROGRESS_INTERVAL_STEPS = 60;
+
+  void applyEvent(Server::Match &match,
+                  const Server::MatchRecording::Event &event) const;
+  void printProgress(const Server::Match &match, std::ostream &output) const;
+
+  const Server::MatchRecording &m_recording;
+  Server::ServerConfig m_config;
+};
+} // namespace Jetpack::Replay
@@ -0,0 +1,92 @@
+#include "../Shared/Exceptions.hpp"
+#include "MatchReplayer.hpp"
+#include <iomanip>
+#include <iostream>
+
+static void usage(char *program_name) {
+  std::cerr << "Usage: " << program_name
+            << " [-f | -s <speed>] [-q] <recording.jprec>" << std::endl;
+}
+
+static void printResults(
+    const char *label, uint32_t steps, int winnerId,
+    const std::vector<Jetpack::Server::MatchRecording::PlayerResult> &results) {
+  std::cout << label << ": " << steps << " steps, winner " << winnerId
+            << std::endl;
+  for (const auto &result : results) {
+    std::cout << "  player " << result.id << "  state "
+              << static_cast<int>(result.state) << "  score " << result.score
+              << "  x " << result.x << "  y " << result.y << std::endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  double speed = 1.0;
+  bool quiet = false;
+  std::string path;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-f") {
+      speed = 0.0;
+    } else if (arg == "-s" && i + 1 < argc) {
+      try {
+        speed = std::stod(argv[++i]);
+      } catch (const std::exception &) {
+        std::cerr << "Error: Invalid speed " << argv[i] << std::endl;
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "-q") {
+      quiet = true;
+    } else if (path.empty() && !arg.empty() && arg[0] != '-') {
+      path = arg;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (path.empty() || speed < 0.0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    const auto recording = Jetpack::Server::MatchRecording::load(path);
+    std::cout << "match " << recording.getMatchId() << ": "
+              << recording.getMapTemplate().map.width << "x"
+              << recording.getMapTemplate().map.height << " map, "
+              << recording.getEvents().size() << " events" << std::endl;
+
+    Jetpack::Replay::MatchReplayer replayer(recording);
+    const bool showProgress = !quiet && speed > 0.0;
+    const auto result =
+        replayer.run(speed, showProgress ? &std::cout : nullptr);
+
+    printResults("recorded", recording.getSteps(), recording.getWinnerId(),
+                 recording.getResults());
+    printResults("replayed", result.steps, result.winnerId, result.results);
+
+    const double playSeconds =
+        result.steps *
+        std::chrono::duration<double>(Jetpack::Server::Match::TICK_PERIOD)
+            .count();
+    std::cout << std::fixed << std::setprecision(3) << "replayed in "
+              << result.seconds << " s ("
+              << (result.seconds > 0.0 ? playSeconds / result.seconds : 0.0)
+              << "x real time)" << std::endl;
+
+    if (!result.matches(recording)) {
+      std::cout << "replay DIVERGED from the recording" << std::endl;
+      return 2;
+    }
+    std::cout << "replay matches the recording" << std::endl;
+  } catch (const Jetpack::Shared::Exceptions::Exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
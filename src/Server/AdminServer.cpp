@@ -0,0 +1,204 @@
+#include "AdminServer.hpp"
+#include "../Shared/Exceptions.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+Jetpack::Server::AdminServer::AdminServer(const std::string &path)
+    : m_path(path) {
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Admin socket path too long: " + path);
+  }
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, path.c_str());
+
+  m_listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (m_listenSocket < 0) {
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Failed to create admin socket");
+  }
+
+  // A socket file left behind by a previous run would make bind() fail.
+  unlink(path.c_str());
+  if (bind(m_listenSocket, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(m_listenSocket, SOMAXCONN) < 0) {
+    close(m_listenSocket);
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Failed to listen on admin socket " + path);
+  }
+  chmod(path.c_str(), S_IRUSR | S_IWUSR);
+
+  m_epollFd = epoll_create1(0);
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = m_listenSocket;
+  if (m_epollFd < 0 ||
+      epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenSocket, &event) < 0) {
+    close(m_listenSocket);
+    unlink(path.c_str());
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Failed to create admin epoll instance");
+  }
+
+  addCommand("help", "help", "list commands", [this](const Arguments &) {
+    size_t width = 0;
+    for (const auto &[_, command] : m_commands) {
+      width = std::max(width, command.usage.size());
+    }
+    std::string text;
+    for (const auto &[_, command] : m_commands) {
+      const std::string padding(width + 2 - command.usage.size(), ' ');
+      text += command.usage + padding + command.description + "\n";
+    }
+    return text;
+  });
+}
+
+Jetpack::Server::AdminServer::~AdminServer() {
+  for (const auto &[socket, _] : m_clients) {
+    close(socket);
+  }
+  close(m_epollFd);
+  close(m_listenSocket);
+  unlink(m_path.c_str());
+}
+
+void Jetpack::Server::AdminServer::addCommand(const std::string &name,
+                                              const std::string &usage,
+                                              const std::string &description,
+                                              Handler handler) {
+  m_commands[name] = {usage, description, std::move(handler)};
+}
+
+void Jetpack::Server::AdminServer::handleEvents() {
+  epoll_event events[MAX_EVENTS];
+  const int count = epoll_wait(m_epollFd, events, MAX_EVENTS, 0);
+
+  for (int i = 0; i < count; i++) {
+    const int socket = events[i].data.fd;
+    if (socket == m_listenSocket) {
+      acceptClients();
+      continue;
+    }
+
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) {
+      continue;
+    }
+
+    bool open = true;
+    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+      open = readClient(socket, it->second);
+    }
+    if (open) {
+      open = flushClient(socket, it->second);
+    }
+    if (!open) {
+      closeClient(socket);
+    }
+  }
+}
+
+void Jetpack::Server::AdminServer::acceptClients() {
+  int socket;
+  while ((socket = accept4(m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK)) >=
+         0) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = socket;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, socket, &event);
+    m_clients.emplace(socket, Client{});
+  }
+}
+
+bool Jetpack::Server::AdminServer::readClient(int socket, Client &client) {
+  char buffer[1024];
+
+  while (true) {
+    const ssize_t bytesRead = recv(socket, buffer, sizeof(buffer), 0);
+    if (bytesRead == 0) {
+      return false;
+    }
+    if (bytesRead < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      return false;
+    }
+    client.input.append(buffer, bytesRead);
+  }
+
+  size_t newline;
+  while ((newline = client.input.find('\n')) != std::string::npos) {
+    std::string line = client.input.substr(0, newline);
+    client.input.erase(0, newline + 1);
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    client.output += execute(line);
+  }
+
+  return client.input.size() <= MAX_LINE_LENGTH;
+}
+
+bool Jetpack::Server::AdminServer::flushClient(int socket, Client &client) {
+  if (!client.output.empty()) {
+    const ssize_t sent =
+        send(socket, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      return false;
+    }
+    if (sent > 0) {
+      client.output.erase(0, sent);
+    }
+  }
+
+  epoll_event event{};
+  event.events = client.output.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT;
+  event.data.fd = socket;
+  epoll_ctl(m_epollFd, EPOLL_CTL_MOD, socket, &event);
+  return true;
+}
+
+std::string Jetpack::Server::AdminServer::execute(const std::string &line) {
+  std::istringstream input(line);
+  Arguments arguments;
+  std::string word;
+  while (input >> word) {
+    arguments.push_back(word);
+  }
+  if (arguments.empty()) {
+    return "";
+  }
+
+  auto it = m_commands.find(arguments[0]);
+  if (it == m_commands.end()) {
+    return "Admin command error: unknown command " + arguments[0] +
+           " (try help)\n";
+  }
+
+  Log::write(LogLevel::INFO, "admin: {}", line);
+  try {
+    return it->second.handler(arguments);
+  } catch (const Jetpack::Shared::Exceptions::Exception &e) {
+    return std::string(e.what()) + "\n";
+  } catch (const std::exception &e) {
+    return std::string("Admin command error: ") + e.what() + "\n";
+  }
+}
+
+void Jetpack::Server::AdminServer::closeClient(int socket) {
+  epoll_ctl(m_epollFd, EPOLL_CTL_DEL, socket, nullptr);
+  close(socket);
+  m_clients.erase(socket);
+}
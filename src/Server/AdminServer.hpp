@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Jetpack::Server {
+// Serves line-based admin commands on a Unix-domain socket. Its sockets are
+// multiplexed through one epoll descriptor that the game loop polls, so
+// commands run between ticks on the game thread and never block them.
+class AdminServer {
+public:
+  using Arguments = std::vector<std::string>;
+  using Handler = std::function<std::string(const Arguments &arguments)>;
+
+  explicit AdminServer(const std::string &path);
+  ~AdminServer();
+
+  AdminServer(const AdminServer &) = delete;
+  AdminServer &operator=(const AdminServer &) = delete;
+
+  void addCommand(const std::string &name, const std::string &usage,
+                  const std::string &description, Handler handler);
+
+  int getPollFd() const { return m_epollFd; }
+  void handleEvents();
+
+private:
+  static constexpr int MAX_EVENTS = 16;
+  static constexpr size_t MAX_LINE_LENGTH = 4096;
+
+  struct Command {
+    std::string usage;
+    std::string description;
+    Handler handler;
+  };
+
+  struct Client {
+    std::string input;
+    std::string output;
+  };
+
+  void acceptClients();
+  bool readClient(int socket, Client &client);
+  bool flushClient(int socket, Client &client);
+  std::string execute(const std::string &line);
+  void closeClient(int socket);
+
+  std::string m_path;
+  int m_listenSocket = -1;
+  int m_epollFd = -1;
+  std::map<std::string, Command> m_commands;
+  std::unordered_map<int, Client> m_clients;
+};
+} // namespace Jetpack::Server
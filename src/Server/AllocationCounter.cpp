@@ -0,0 +1,59 @@
+#include "AllocationCounter.hpp"
+
+#ifdef JETPACK_ALLOCATION_CHECK
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+thread_local uint64_t allocationCount = 0;
+
+void *countedAllocate(std::size_t size, std::size_t alignment) {
+  allocationCount++;
+
+  if (size == 0) {
+    size = 1;
+  }
+  void *pointer = nullptr;
+  if (alignment > alignof(std::max_align_t)) {
+    size_t roundedSize = (size + alignment - 1) / alignment * alignment;
+    pointer = std::aligned_alloc(alignment, roundedSize);
+  } else {
+    pointer = std::malloc(size);
+  }
+
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+} // namespace
+
+void *operator new(std::size_t size) {
+  return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+uint64_t Jetpack::Server::AllocationCounter::getAllocationCount() {
+  return allocationCount;
+}
+#else
+uint64_t Jetpack::Server::AllocationCounter::getAllocationCount() { return 0; }
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Jetpack::Server {
+class AllocationCounter {
+public:
+#ifdef JETPACK_ALLOCATION_CHECK
+  static constexpr bool ENABLED = true;
+#else
+  static constexpr bool ENABLED = false;
+#endif
+
+  // Heap allocations made so far by the calling thread. Counts are kept
+  // per thread so that a check around a tick is not disturbed by other
+  // threads of the process.
+  static uint64_t getAllocationCount();
+};
+} // namespace Jetpack::Server
@@ -1,27 +1,53 @@
 #include "Broadcaster.hpp"
+#include "../Shared/PacketCodec.hpp"
 #include <algorithm>
-#include <format>
-#include <iostream>
 #include <sys/socket.h>
 
+void Jetpack::Server::Broadcaster::broadcast(const uint8_t *data,
+                                             size_t length) {
+  for (const auto &[playerSocket, _] : m_serverPlayersReference) {
+    sendTo(playerSocket, data, length);
+  }
+}
+
+void Jetpack::Server::Broadcaster::sendTo(int playerSocket,
+                                          const uint8_t *data, size_t length) {
+  // Players without a socket are simulated headlessly.
+  if (m_offline || playerSocket < 0) {
+    return;
+  }
+  ssize_t sent = send(playerSocket, data, length, 0);
+  if (m_metrics && sent > 0) {
+    m_metrics->add(Metrics::Counter::PACKETS_SENT);
+    m_metrics->add(Metrics::Counter::BYTES_SENT, sent);
+  }
+  if (m_packetLogger) {
+    m_packetLogger->record(Shared::PacketLogger::Direction::OUTGOING,
+                           playerSocket, data, length);
+  }
+}
+
+void Jetpack::Server::Broadcaster::broadcastEvent(int playerId,
+                                                  const uint8_t *data,
+                                                  size_t length) {
+  if (!m_ownerOnlyEvents) {
+    broadcast(data, length);
+    return;
+  }
+  for (const auto &[playerSocket, player] : m_serverPlayersReference) {
+    if (player.getId() == playerId) {
+      sendTo(playerSocket, data, length);
+    }
+  }
+}
+
 void Jetpack::Server::Broadcaster::broadcastGameOver(int winnerId) {
   uint8_t buffer[3];
   buffer[0] = static_cast<uint8_t>(Shared::Protocol::PacketType::GAME_OVER);
   buffer[1] = (winnerId > 0) ? 1 : 0;
   buffer[2] = (winnerId > 0) ? winnerId : 0;
 
-  for (const auto &[playerSocket, _] : m_serverPlayersReference) {
-    send(playerSocket, buffer, sizeof(buffer), 0);
-    if (m_debugMode) {
-      std::cout << std::format(
-          "Debug: Sent game over broadcast to client {} - Buffer: ",
-          playerSocket);
-      for (size_t i = 0; i < sizeof(buffer); i++) {
-        std::cout << std::format("{:02X} ", buffer[i]);
-      }
-      std::cout << std::endl;
-    }
-  }
+  broadcast(buffer, sizeof(buffer));
 }
 
 void Jetpack::Server::Broadcaster::broadcastPlayerDeath(int playerId) {
@@ -29,18 +55,7 @@ void Jetpack::Server::Broadcaster::broadcastPlayerDeath(int playerId) {
   buffer[0] = static_cast<uint8_t>(Shared::Protocol::PacketType::PLAYER_DEATH);
   buffer[1] = playerId;
 
-  for (const auto &[playerSocket, _] : m_serverPlayersReference) {
-    send(playerSocket, buffer, sizeof(buffer), 0);
-    if (m_debugMode) {
-      std::cout << std::format(
-          "Debug: Sent player death broadcast to client {} - Buffer: ",
-          playerSocket);
-      for (size_t i = 0; i < sizeof(buffer); i++) {
-        std::cout << std::format("{:02X} ", buffer[i]);
-      }
-      std::cout << std::endl;
-    }
-  }
+  broadcastEvent(playerId, buffer, sizeof(buffer));
 }
 
 void Jetpack::Server::Broadcaster::broadcastCoinCollected(int playerId, int x,
@@ -60,30 +75,25 @@ void Jetpack::Server::Broadcaster::broadcastCoinCollected(int playerId, int x,
                           ->first)
                   .getScore();
 
-  for (const auto &[playerSocket, _] : m_serverPlayersReference) {
-    send(playerSocket, buffer, sizeof(buffer), 0);
-    if (m_debugMode) {
-      std::cout << std::format(
-          "Debug: Sent coin collected broadcast to client {} - Buffer: ",
-          playerSocket);
-      for (size_t i = 0; i < sizeof(buffer); i++) {
-        std::cout << std::format("{:02X} ", buffer[i]);
-      }
-      std::cout << std::endl;
-    }
-  }
+  broadcastEvent(playerId, buffer, sizeof(buffer));
 }
 
-void Jetpack::Server::Broadcaster::broadcastGameState() {
-  size_t playerDataSize = 10;
-  size_t bufferSize = 2 + (m_serverPlayersReference.size() * playerDataSize);
-  std::vector<uint8_t> buffer(bufferSize);
+void Jetpack::Server::Broadcaster::broadcastGameState(uint32_t step) {
+  size_t playerDataSize = Shared::PacketCodec::PLAYER_STATE_SIZE;
+  size_t bufferSize = Shared::PacketCodec::GAME_STATE_HEADER_SIZE +
+                      (m_serverPlayersReference.size() * playerDataSize);
+  std::pmr::vector<uint8_t> &buffer = m_stateBuffer;
+  buffer.resize(bufferSize);
 
   buffer[0] =
       static_cast<uint8_t>(Shared::Protocol::PacketType::GAME_STATE_UPDATE);
   buffer[1] = m_serverPlayersReference.size();
+  buffer[2] = step & 0xFF;
+  buffer[3] = (step >> 8) & 0xFF;
+  buffer[4] = (step >> 16) & 0xFF;
+  buffer[5] = (step >> 24) & 0xFF;
 
-  size_t offset = 2;
+  size_t offset = Shared::PacketCodec::GAME_STATE_HEADER_SIZE;
   for (const auto &[_, player] : m_serverPlayersReference) {
     buffer[offset] = player.getId();
     buffer[offset + 1] = static_cast<uint8_t>(player.getState());
@@ -102,24 +112,17 @@ void Jetpack::Server::Broadcaster::broadcastGameState() {
     buffer[offset + 7] = (player.getScore() >> 8) & 0xFF;
 
     buffer[offset + 8] = player.isJetpacking() ? 1 : 0;
+    buffer[offset + 9] = static_cast<uint8_t>(
+        Shared::PacketCodec::encodeVelocity(player.getVelocityY()));
 
-    buffer[offset + 9] = 0;
+    // Echoes the last input applied, so clients can time the round trip.
+    buffer[offset + 10] = player.getInputSequence() & 0xFF;
+    buffer[offset + 11] = (player.getInputSequence() >> 8) & 0xFF;
 
     offset += playerDataSize;
   }
 
-  for (const auto &[playerSocket, _] : m_serverPlayersReference) {
-    send(playerSocket, buffer.data(), buffer.size(), 0);
-    if (m_debugMode) {
-      std::cout << std::format(
-          "Debug: Sent game state update broadcast to client {} - Buffer: ",
-          playerSocket);
-      for (size_t i = 0; i < buffer.size(); i++) {
-        std::cout << std::format("{:02X} ", buffer[i]);
-      }
-      std::cout << std::endl;
-    }
-  }
+  broadcast(buffer.data(), buffer.size());
 }
 
 void Jetpack::Server::Broadcaster::broadcastGameStart() {
@@ -128,16 +131,76 @@ void Jetpack::Server::Broadcaster::broadcastGameStart() {
   buffer[1] = m_serverPlayersReference.size();
   buffer[2] = 0;
 
-  for (const auto &[playerSocket, _] : m_serverPlayersReference) {
-    send(playerSocket, buffer, sizeof(buffer), 0);
-    if (m_debugMode) {
-      std::cout << std::format(
-          "Debug: Sent game start broadcast to client {} - Buffer: ",
-          playerSocket);
-      for (size_t i = 0; i < sizeof(buffer); i++) {
-        std::cout << std::format("{:02X} ", buffer[i]);
-      }
-      std::cout << std::endl;
+  broadcast(buffer, sizeof(buffer));
+}
+
+void Jetpack::Server::Broadcaster::broadcastEntities(
+    const EntityStore &entities, float behind, float ahead) {
+  if (m_offline) {
+    return;
+  }
+
+  constexpr size_t headerSize = Shared::Protocol::ENTITY_UPDATE_HEADER_SIZE;
+  constexpr size_t dataSize = Shared::Protocol::ENTITY_DATA_SIZE;
+  // Sized for every entity once so that snapshots never allocate.
+  if (m_entityOrder.capacity() < entities.size()) {
+    m_entityOrder.reserve(entities.size());
+    m_entityX.reserve(entities.size());
+    m_entityRecords.reserve(entities.size() * dataSize);
+    m_entityBuffer.reserve(headerSize + entities.size() * dataSize);
+  }
+
+  const std::span<const uint32_t> nearby = entities.getNearby();
+  m_entityOrder.assign(nearby.begin(), nearby.end());
+  std::sort(m_entityOrder.begin(), m_entityOrder.end(),
+            [&entities](uint32_t a, uint32_t b) {
+              return entities.getX(a) < entities.getX(b);
+            });
+
+  m_entityX.clear();
+  m_entityRecords.resize(m_entityOrder.size() * dataSize);
+  uint8_t *record = m_entityRecords.data();
+  for (uint32_t id : m_entityOrder) {
+    m_entityX.push_back(entities.getX(id));
+
+    int32_t xFixedPrecision = static_cast<int32_t>(entities.getX(id) * 100);
+    int16_t yFixedPrecision = static_cast<int16_t>(entities.getY(id) * 100);
+
+    record[0] = id & 0xFF;
+    record[1] = (id >> 8) & 0xFF;
+    record[2] = static_cast<uint8_t>(entities.getType(id)) |
+                (entities.isActive(id) ? 0x80 : 0x00);
+    record[3] = xFixedPrecision & 0xFF;
+    record[4] = (xFixedPrecision >> 8) & 0xFF;
+    record[5] = (xFixedPrecision >> 16) & 0xFF;
+    record[6] = (xFixedPrecision >> 24) & 0xFF;
+    record[7] = yFixedPrecision & 0xFF;
+    record[8] = (yFixedPrecision >> 8) & 0xFF;
+    record += dataSize;
+  }
+
+  for (const auto &[playerSocket, player] : m_serverPlayersReference) {
+    if (playerSocket < 0) {
+      continue;
     }
+
+    const float x = player.getPosition().x;
+    const size_t first =
+        std::lower_bound(m_entityX.begin(), m_entityX.end(), x - behind) -
+        m_entityX.begin();
+    const size_t last =
+        std::upper_bound(m_entityX.begin(), m_entityX.end(), x + ahead) -
+        m_entityX.begin();
+    const size_t count = std::min<size_t>(last - first, UINT16_MAX);
+
+    m_entityBuffer.resize(headerSize + count * dataSize);
+    m_entityBuffer[0] =
+        static_cast<uint8_t>(Shared::Protocol::PacketType::ENTITY_UPDATE);
+    m_entityBuffer[1] = count & 0xFF;
+    m_entityBuffer[2] = (count >> 8) & 0xFF;
+    std::copy_n(m_entityRecords.data() + first * dataSize, count * dataSize,
+                m_entityBuffer.data() + headerSize);
+
+    sendTo(playerSocket, m_entityBuffer.data(), m_entityBuffer.size());
   }
 }
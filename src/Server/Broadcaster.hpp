@@ -1,25 +1,59 @@
 #pragma once
 
+#include "../Shared/PacketLogger.hpp"
 #include "../Shared/Protocol.hpp"
+#include "EntityStore.hpp"
+#include "MatchServices.hpp"
+#include "Metrics.hpp"
+#include <memory_resource>
 #include <unordered_map>
+#include <vector>
 
 namespace Jetpack::Server {
+using PlayerMap = std::pmr::unordered_map<int, Shared::Protocol::Player>;
+
 class Broadcaster {
 public:
-  Broadcaster(
-      std::unordered_map<int, Shared::Protocol::Player> &serverPlayersReference,
-      bool debugMode = false)
+  Broadcaster(PlayerMap &serverPlayersReference,
+              const MatchServices &services = {},
+              std::pmr::memory_resource *resource =
+                  std::pmr::get_default_resource())
       : m_serverPlayersReference(serverPlayersReference),
-        m_debugMode(debugMode) {}
+        m_packetLogger(services.packetLogger), m_metrics(services.metrics),
+        m_offline(services.offline),
+        m_stateBuffer(resource), m_entityOrder(resource), m_entityX(resource),
+        m_entityRecords(resource), m_entityBuffer(resource) {}
 
   void broadcastGameStart();
-  void broadcastGameState();
+  void broadcastGameState(uint32_t step);
   void broadcastCoinCollected(int playerId, int x, int y);
   void broadcastPlayerDeath(int playerId);
   void broadcastGameOver(int winnerId = -1);
+  // Sends each player the entities from behind to ahead of its position,
+  // out of those the last EntityStore::update visited.
+  void broadcastEntities(const EntityStore &entities, float behind,
+                         float ahead);
+
+  // Under overload, coin and death events only reach the player concerned;
+  // the others pick up score and state from the next snapshot.
+  void setOwnerOnlyEvents(bool ownerOnly) { m_ownerOnlyEvents = ownerOnly; }
 
 private:
-  std::unordered_map<int, Shared::Protocol::Player> &m_serverPlayersReference;
-  bool m_debugMode = false;
+  void broadcast(const uint8_t *data, size_t length);
+  void sendTo(int playerSocket, const uint8_t *data, size_t length);
+  void broadcastEvent(int playerId, const uint8_t *data, size_t length);
+
+  PlayerMap &m_serverPlayersReference;
+  Shared::PacketLogger *m_packetLogger = nullptr;
+  Metrics *m_metrics = nullptr;
+  bool m_offline = false;
+  bool m_ownerOnlyEvents = false;
+
+  std::pmr::vector<uint8_t> m_stateBuffer;
+  // The entities to send, encoded once per snapshot in x order.
+  std::pmr::vector<uint32_t> m_entityOrder;
+  std::pmr::vector<float> m_entityX;
+  std::pmr::vector<uint8_t> m_entityRecords;
+  std::pmr::vector<uint8_t> m_entityBuffer;
 };
 } // namespace Jetpack::Server
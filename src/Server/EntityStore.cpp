@@ -0,0 +1,199 @@
+#include "EntityStore.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+Jetpack::Server::EntityStore::EntityStore(std::pmr::memory_resource *resource)
+    : m_types(resource), m_x(resource), m_y(resource), m_originX(resource),
+      m_originY(resource), m_phase(resource), m_flags(resource),
+      m_bySpawnX(resource), m_launched(resource), m_nearby(resource),
+      m_sortedTargetX(resource) {}
+
+void Jetpack::Server::EntityStore::clear() {
+  m_types.clear();
+  m_x.clear();
+  m_y.clear();
+  m_originX.clear();
+  m_originY.clear();
+  m_phase.clear();
+  m_flags.clear();
+  m_bySpawnX.clear();
+  m_launched.clear();
+  m_nearby.clear();
+}
+
+size_t Jetpack::Server::EntityStore::spawn(Shared::Protocol::EntityType type,
+                                           float x, float y) {
+  if (type == Shared::Protocol::EntityType::LASER) {
+    x += Shared::Protocol::getEntityHalfExtent(type).x - 0.5f;
+  }
+
+  m_types.push_back(type);
+  m_x.push_back(x);
+  m_y.push_back(y);
+  m_originX.push_back(x);
+  m_originY.push_back(y);
+  m_phase.push_back(static_cast<uint32_t>(x * 7.0f));
+  m_flags.push_back(FLAG_ALIVE | FLAG_ACTIVE);
+  return m_types.size() - 1;
+}
+
+void Jetpack::Server::EntityStore::prepare() {
+  m_bySpawnX.resize(m_types.size());
+  std::iota(m_bySpawnX.begin(), m_bySpawnX.end(), 0);
+  std::sort(m_bySpawnX.begin(), m_bySpawnX.end(),
+            [this](uint32_t a, uint32_t b) {
+              return m_originX[a] < m_originX[b];
+            });
+
+  // Sized once so that updates never allocate.
+  m_launched.reserve(m_types.size());
+  m_nearby.reserve(m_types.size());
+}
+
+void Jetpack::Server::EntityStore::update(
+    uint32_t tick, float mapHeight,
+    const std::pmr::vector<Shared::Protocol::Position> &targets, float behind,
+    float ahead) {
+  if (m_bySpawnX.size() != m_types.size()) {
+    prepare();
+  }
+
+  m_sortedTargetX.clear();
+  for (const auto &target : targets) {
+    m_sortedTargetX.push_back(target.x);
+  }
+  std::sort(m_sortedTargetX.begin(), m_sortedTargetX.end());
+
+  m_nearby.clear();
+  // Missiles in flight move wherever the players are.
+  size_t kept = 0;
+  for (uint32_t id : m_launched) {
+    updateMissile(id, targets);
+    if (m_flags[id] & FLAG_ALIVE) {
+      m_launched[kept++] = id;
+      m_nearby.push_back(id);
+    }
+  }
+  m_launched.resize(kept);
+
+  // Windows of targets closer than their length are merged so that no
+  // entity is visited twice.
+  auto spawnsBefore = [this](uint32_t id, float x) {
+    return m_originX[id] < x;
+  };
+  auto spawnsAfter = [this](float x, uint32_t id) {
+    return x < m_originX[id];
+  };
+  auto first = m_bySpawnX.begin();
+  for (size_t i = 0; i < m_sortedTargetX.size();) {
+    const float from = m_sortedTargetX[i] - behind;
+    float to = m_sortedTargetX[i] + ahead;
+    for (i++; i < m_sortedTargetX.size() &&
+              m_sortedTargetX[i] - behind <= to;
+         i++) {
+      to = m_sortedTargetX[i] + ahead;
+    }
+
+    first = std::lower_bound(first, m_bySpawnX.end(), from, spawnsBefore);
+    const auto last =
+        std::upper_bound(first, m_bySpawnX.end(), to, spawnsAfter);
+    for (auto it = first; it != last; it++) {
+      const uint32_t id = *it;
+      if ((m_flags[id] & (FLAG_ALIVE | FLAG_LAUNCHED)) != FLAG_ALIVE) {
+        continue;
+      }
+      updateEntity(id, tick, mapHeight, targets);
+      if (!(m_flags[id] & FLAG_ALIVE)) {
+        continue;
+      }
+      if (m_flags[id] & FLAG_LAUNCHED) {
+        m_launched.push_back(id);
+      }
+      m_nearby.push_back(id);
+    }
+    first = last;
+  }
+}
+
+void Jetpack::Server::EntityStore::updateEntity(
+    size_t id, uint32_t tick, float mapHeight,
+    const std::pmr::vector<Shared::Protocol::Position> &targets) {
+  switch (m_types[id]) {
+  case Shared::Protocol::EntityType::ZAPPER:
+    updateZapper(id, tick, mapHeight);
+    break;
+  case Shared::Protocol::EntityType::MISSILE:
+    updateMissile(id, targets);
+    break;
+  case Shared::Protocol::EntityType::LASER:
+    updateLaser(id, tick);
+    break;
+  }
+}
+
+bool Jetpack::Server::EntityStore::isLethalAt(size_t id, float x,
+                                              float y) const {
+  if ((m_flags[id] & (FLAG_ALIVE | FLAG_ACTIVE)) !=
+      (FLAG_ALIVE | FLAG_ACTIVE)) {
+    return false;
+  }
+
+  Shared::Protocol::Position extent =
+      Shared::Protocol::getEntityHalfExtent(m_types[id]);
+  return std::abs(x - m_x[id]) <= extent.x && std::abs(y - m_y[id]) <= extent.y;
+}
+
+void Jetpack::Server::EntityStore::updateZapper(size_t id, uint32_t tick,
+                                                float mapHeight) {
+  uint32_t step = (tick + m_phase[id]) % ZAPPER_SWEEP_TICKS;
+  float progress = static_cast<float>(step) / ZAPPER_SWEEP_TICKS;
+  float wave = (progress < 0.5f) ? (4.0f * progress - 1.0f)
+                                 : (3.0f - 4.0f * progress);
+
+  m_y[id] = std::clamp(m_originY[id] + wave * ZAPPER_SWEEP_RANGE, 0.5f,
+                       mapHeight - 0.5f);
+}
+
+void Jetpack::Server::EntityStore::updateMissile(
+    size_t id, const std::pmr::vector<Shared::Protocol::Position> &targets) {
+  if (!(m_flags[id] & FLAG_LAUNCHED)) {
+    auto it = std::lower_bound(m_sortedTargetX.begin(), m_sortedTargetX.end(),
+                               m_x[id] - MISSILE_TRIGGER_RANGE);
+    if (it == m_sortedTargetX.end() || *it > m_x[id]) {
+      return;
+    }
+    m_flags[id] |= FLAG_LAUNCHED;
+  }
+
+  m_x[id] -= MISSILE_SPEED;
+  if (m_x[id] < -1.0f) {
+    m_flags[id] &= ~(FLAG_ALIVE | FLAG_ACTIVE);
+    return;
+  }
+
+  const Shared::Protocol::Position *nearest = nullptr;
+  float nearestDistance = 0.0f;
+  for (const auto &target : targets) {
+    float distance = std::abs(target.x - m_x[id]);
+    if (!nearest || distance < nearestDistance) {
+      nearest = &target;
+      nearestDistance = distance;
+    }
+  }
+
+  if (nearest) {
+    m_y[id] += std::clamp(nearest->y - m_y[id], -MISSILE_TURN_RATE,
+                          MISSILE_TURN_RATE);
+  }
+}
+
+void Jetpack::Server::EntityStore::updateLaser(size_t id, uint32_t tick) {
+  uint32_t step = (tick + m_phase[id]) % (LASER_ON_TICKS + LASER_OFF_TICKS);
+
+  if (step < LASER_ON_TICKS) {
+    m_flags[id] |= FLAG_ACTIVE;
+  } else {
+    m_flags[id] &= ~FLAG_ACTIVE;
+  }
+}
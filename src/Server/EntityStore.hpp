@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../Shared/Protocol.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace Jetpack::Server {
+// Entities only change near the players: zappers and lasers follow the tick,
+// so one that has been skipped is exact again as soon as it is updated, and
+// missiles wait where they spawned until a player comes in range. Updates
+// therefore visit the entities around the targets, found by spawn column,
+// plus the missiles already in flight. The others keep their last state.
+class EntityStore {
+public:
+  explicit EntityStore(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  void clear();
+  size_t spawn(Shared::Protocol::EntityType type, float x, float y);
+  // Updates the entities within [x - behind, x + ahead] of any target.
+  void update(uint32_t tick, float mapHeight,
+              const std::pmr::vector<Shared::Protocol::Position> &targets,
+              float behind, float ahead);
+
+  size_t size() const { return m_types.size(); }
+  // The live entities visited by the last update.
+  std::span<const uint32_t> getNearby() const { return m_nearby; }
+
+  Shared::Protocol::EntityType getType(size_t id) const { return m_types[id]; }
+  float getX(size_t id) const { return m_x[id]; }
+  float getY(size_t id) const { return m_y[id]; }
+  bool isAlive(size_t id) const { return m_flags[id] & FLAG_ALIVE; }
+  bool isActive(size_t id) const { return m_flags[id] & FLAG_ACTIVE; }
+
+  bool isLethalAt(size_t id, float x, float y) const;
+
+private:
+  static constexpr uint8_t FLAG_ALIVE = 1 << 0;
+  static constexpr uint8_t FLAG_ACTIVE = 1 << 1;
+  static constexpr uint8_t FLAG_LAUNCHED = 1 << 2;
+
+  static constexpr uint32_t ZAPPER_SWEEP_TICKS = 120;
+  static constexpr float ZAPPER_SWEEP_RANGE = 2.0f;
+
+  static constexpr float MISSILE_TRIGGER_RANGE = 12.0f;
+  static constexpr float MISSILE_SPEED = 0.12f;
+  static constexpr float MISSILE_TURN_RATE = 0.02f;
+
+  static constexpr uint32_t LASER_ON_TICKS = 90;
+  static constexpr uint32_t LASER_OFF_TICKS = 90;
+
+  void updateZapper(size_t id, uint32_t tick, float mapHeight);
+  void
+  updateMissile(size_t id,
+                const std::pmr::vector<Shared::Protocol::Position> &targets);
+  void updateLaser(size_t id, uint32_t tick);
+  void
+  updateEntity(size_t id, uint32_t tick, float mapHeight,
+               const std::pmr::vector<Shared::Protocol::Position> &targets);
+  void prepare();
+
+  std::pmr::vector<Shared::Protocol::EntityType> m_types;
+  std::pmr::vector<float> m_x;
+  std::pmr::vector<float> m_y;
+  std::pmr::vector<float> m_originX;
+  std::pmr::vector<float> m_originY;
+  std::pmr::vector<uint32_t> m_phase;
+  std::pmr::vector<uint8_t> m_flags;
+
+  // Ids ordered by spawn x, built on the first update after a spawn.
+  std::pmr::vector<uint32_t> m_bySpawnX;
+  std::pmr::vector<uint32_t> m_launched;
+  std::pmr::vector<uint32_t> m_nearby;
+  std::pmr::vector<float> m_sortedTargetX;
+};
+} // namespace Jetpack::Server
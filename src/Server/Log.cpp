@@ -0,0 +1,39 @@
+#include "Log.hpp"
+#include <chrono>
+#include <iostream>
+
+std::atomic<Jetpack::Server::LogLevel> Jetpack::Server::Log::s_level{
+    LogLevel::WARNING};
+
+const char *Jetpack::Server::Log::toString(LogLevel level) {
+  switch (level) {
+  case LogLevel::ERROR:
+    return "error";
+  case LogLevel::WARNING:
+    return "warning";
+  case LogLevel::INFO:
+    return "info";
+  case LogLevel::DEBUG:
+    return "debug";
+  }
+  return "unknown";
+}
+
+bool Jetpack::Server::Log::parse(std::string_view name, LogLevel &level) {
+  for (LogLevel candidate : {LogLevel::ERROR, LogLevel::WARNING,
+                             LogLevel::INFO, LogLevel::DEBUG}) {
+    if (name == toString(candidate)) {
+      level = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Jetpack::Server::Log::writeLine(LogLevel level,
+                                     const std::string &message) {
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  std::cerr << std::format("[{}.{:03}] {}: {}\n", now.count() / 1000,
+                           now.count() % 1000, toString(level), message);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Jetpack::Server {
+enum class LogLevel { ERROR, WARNING, INFO, DEBUG };
+
+// Leveled server log on stderr. The level can be changed at runtime, and
+// messages below it are never formatted.
+class Log {
+public:
+  static LogLevel getLevel() {
+    return s_level.load(std::memory_order_relaxed);
+  }
+  static void setLevel(LogLevel level) {
+    s_level.store(level, std::memory_order_relaxed);
+  }
+  static bool isEnabled(LogLevel level) { return level <= getLevel(); }
+
+  static const char *toString(LogLevel level);
+  static bool parse(std::string_view name, LogLevel &level);
+
+  template <typename... Args>
+  static void write(LogLevel level, std::format_string<Args...> format,
+                    Args &&...args) {
+    if (isEnabled(level)) {
+      writeLine(level, std::format(format, std::forward<Args>(args)...));
+    }
+  }
+
+private:
+  static void writeLine(LogLevel level, const std::string &message);
+
+  static std::atomic<LogLevel> s_level;
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,65 @@
+#include "MapLoader.hpp"
+#include <string>
+#include <vector>
+
+bool Jetpack::Server::MapLoader::load(std::istream &input,
+                                      MapTemplate &mapTemplate) {
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(input, line)) {
+    if (!line.empty()) {
+      lines.push_back(line);
+    }
+  }
+
+  if (lines.empty()) {
+    return false;
+  }
+
+  Shared::Protocol::GameMap &map = mapTemplate.map;
+  map.height = lines.size();
+  map.width = lines[0].length();
+
+  for (const auto &line : lines) {
+    if (line.length() != static_cast<size_t>(map.width)) {
+      return false;
+    }
+  }
+
+  map.tiles.resize(map.height,
+                   std::pmr::vector<Shared::Protocol::TileType>(
+                       map.width, Shared::Protocol::TileType::EMPTY));
+
+  for (int y = 0; y < map.height; y++) {
+    for (int x = 0; x < map.width; x++) {
+      switch (lines[y][x]) {
+      case '_':
+        map.tiles[y][x] = Shared::Protocol::TileType::EMPTY;
+        break;
+      case 'c':
+        map.tiles[y][x] = Shared::Protocol::TileType::COIN;
+        break;
+      case 'e':
+        map.tiles[y][x] = Shared::Protocol::TileType::ELECTRICSQUARE;
+        break;
+      case 'z':
+        mapTemplate.entities.push_back(
+            {Shared::Protocol::EntityType::ZAPPER, x + 0.5f, y + 0.5f});
+        break;
+      case 'm':
+        mapTemplate.entities.push_back(
+            {Shared::Protocol::EntityType::MISSILE, x + 0.5f, y + 0.5f});
+        break;
+      case 'l':
+        mapTemplate.entities.push_back(
+            {Shared::Protocol::EntityType::LASER, x + 0.5f, y + 0.5f});
+        break;
+      default:
+        map.tiles[y][x] = Shared::Protocol::TileType::EMPTY;
+        break;
+      }
+    }
+  }
+
+  return true;
+}
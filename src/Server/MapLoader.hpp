@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Match.hpp"
+#include <istream>
+
+namespace Jetpack::Server {
+class MapLoader {
+public:
+  static bool load(std::istream &input, MapTemplate &mapTemplate);
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,454 @@
+#include "Match.hpp"
+#include "MatchRecording.hpp"
+#include "../Shared/Physics.hpp"
+#include "../Shared/Trace.hpp"
+#include <algorithm>
+
+Jetpack::Server::Match::Match(std::pmr::memory_resource *resource,
+                              const MapTemplate &mapTemplate,
+                              const ServerConfig &config,
+                              const MatchServices &services, uint32_t id)
+    : m_id(id), m_playersPerMatch(config.playersPerMatch),
+      m_threadPool(services.threadPool), m_metrics(services.metrics),
+      m_map(resource), m_players(resource),
+      m_broadcaster(m_players, services, resource),
+      m_entities(resource), m_entityHash(resource),
+      m_entityTargets(resource), m_queuedInputs(resource),
+      m_inputCheckSteps(resource), m_tickPlayers(resource),
+      m_collisionEvents(resource) {
+  m_map.width = mapTemplate.map.width;
+  m_map.height = mapTemplate.map.height;
+  m_map.tiles = mapTemplate.map.tiles;
+
+  for (const auto &spawn : mapTemplate.entities) {
+    m_entities.spawn(spawn.type, spawn.x, spawn.y);
+  }
+
+  if (m_threadPool) {
+    m_collisionEvents.resize(m_threadPool->getThreadCount());
+  }
+}
+
+int Jetpack::Server::Match::addPlayer(int clientSocket) {
+  int playerId = m_players.size() + 1;
+  m_players.emplace(clientSocket,
+                    Shared::Protocol::Player(clientSocket, playerId));
+  m_inputCheckSteps.emplace(clientSocket, 0);
+  if (m_recording) {
+    m_recording->record(m_step, MatchRecording::EventType::JOIN, clientSocket);
+  }
+  return playerId;
+}
+
+void Jetpack::Server::Match::removePlayer(int clientSocket) {
+  auto it = m_players.find(clientSocket);
+  if (it != m_players.end()) {
+    m_players.erase(it);
+    m_inputCheckSteps.erase(clientSocket);
+    if (m_recording) {
+      m_recording->record(m_step, MatchRecording::EventType::LEAVE,
+                          clientSocket);
+    }
+  }
+
+  if (m_gameState == Shared::Protocol::GameState::IN_PROGRESS) {
+    int activePlayers = 0;
+    for (const auto &[_, player] : m_players) {
+      if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
+        activePlayers++;
+      }
+    }
+
+    if (activePlayers < MIN_PLAYERS) {
+      m_gameState = Shared::Protocol::GameState::GAME_OVER;
+      m_broadcaster.broadcastGameOver();
+    }
+  }
+}
+
+void Jetpack::Server::Match::forceEnd() {
+  if (m_gameState == Shared::Protocol::GameState::GAME_OVER) {
+    return;
+  }
+
+  if (m_recording) {
+    m_recording->record(m_step, MatchRecording::EventType::END, -1);
+  }
+  m_gameState = Shared::Protocol::GameState::GAME_OVER;
+  m_broadcaster.broadcastGameOver();
+}
+
+void Jetpack::Server::Match::setDegradation(
+    const MatchDegradation &degradation) {
+  m_degradation = degradation;
+  m_broadcaster.setOwnerOnlyEvents(degradation.ownerOnlyEvents);
+}
+
+void Jetpack::Server::Match::setPlayerInput(int clientSocket, bool jetpacking,
+                                            uint16_t sequence) {
+  auto it = m_players.find(clientSocket);
+  if (it == m_players.end()) {
+    return;
+  }
+
+  it->second.setInputSequence(sequence);
+  if (it->second.getState() != Shared::Protocol::PlayerState::PLAYING) {
+    return;
+  }
+
+  // Only changes matter to the simulation, so only changes are recorded.
+  if (m_recording && it->second.isJetpacking() != jetpacking) {
+    m_recording->record(m_step, MatchRecording::EventType::INPUT,
+                        clientSocket, jetpacking);
+  }
+  it->second.setJetpacking(jetpacking);
+}
+
+void Jetpack::Server::Match::queuePlayerInput(int clientSocket,
+                                              bool jetpacking,
+                                              uint16_t sequence,
+                                              uint32_t step) {
+  if (!m_players.contains(clientSocket)) {
+    return;
+  }
+
+  const QueuedInput *last = nullptr;
+  size_t queued = 0;
+  for (const QueuedInput &input : m_queuedInputs) {
+    if (input.clientSocket == clientSocket) {
+      last = &input;
+      queued++;
+    }
+  }
+  if (queued >= MAX_QUEUED_INPUTS_PER_PLAYER) {
+    return;
+  }
+
+  const uint32_t nextStep = m_step + 1;
+  QueuedInput input;
+  input.clientSocket = clientSocket;
+  input.sequence = sequence;
+  input.jetpacking = jetpacking;
+  input.delay = last ? last->delay : (nextStep > step ? nextStep - step : 0);
+
+  const uint32_t earliest = last ? last->step + 1 : nextStep;
+  input.step = std::clamp(step + input.delay, earliest,
+                          std::max(earliest, nextStep + MAX_INPUT_LEAD_STEPS));
+  m_queuedInputs.push_back(input);
+}
+
+void Jetpack::Server::Match::applyQueuedInputs() {
+  const uint32_t nextStep = m_step + 1;
+
+  size_t kept = 0;
+  for (size_t i = 0; i < m_queuedInputs.size(); i++) {
+    const QueuedInput input = m_queuedInputs[i];
+    auto it = m_players.find(input.clientSocket);
+    if (it == m_players.end()) {
+      continue;
+    }
+
+    // Edges wait for the player to start moving. Only a player's oldest
+    // edge is looked at each step, which keeps them in order and a step
+    // apart. Every player has an entry, so this lookup never inserts.
+    uint32_t &checkStep = m_inputCheckSteps[input.clientSocket];
+    const bool due =
+        input.step <= nextStep &&
+        it->second.getState() != Shared::Protocol::PlayerState::READY &&
+        checkStep != nextStep;
+    checkStep = nextStep;
+    if (!due) {
+      m_queuedInputs[kept++] = input;
+      continue;
+    }
+
+    setPlayerInput(input.clientSocket, input.jetpacking, input.sequence);
+  }
+  m_queuedInputs.resize(kept);
+}
+
+void Jetpack::Server::Match::checkGameStart() {
+  if (m_gameState != Shared::Protocol::GameState::WAITING_FOR_PLAYERS) {
+    return;
+  }
+
+  int readyPlayersCount = m_players.size();
+
+  if (readyPlayersCount >= m_playersPerMatch) {
+    m_gameState = Shared::Protocol::GameState::IN_PROGRESS;
+
+    for (auto &[_, player] : m_players) {
+      player.setState(Shared::Protocol::PlayerState::READY);
+      player.setPosition(1.0f, m_map.height - 2.0f);
+    }
+
+    m_broadcaster.broadcastGameStart();
+    m_broadcaster.broadcastGameState(m_step);
+  }
+}
+
+void Jetpack::Server::Match::updateGameState() {
+  TRACE_SCOPE("Match::updateGameState");
+  if (m_gameState != Shared::Protocol::GameState::IN_PROGRESS) {
+    return;
+  }
+  // Before the step counter moves, so that recordings stamp these inputs
+  // exactly like ones set directly between ticks.
+  if (!m_queuedInputs.empty()) {
+    applyQueuedInputs();
+  }
+  m_step++;
+
+  bool allReady = true;
+  bool anyPlaying = false;
+
+  for (const auto &[_, player] : m_players) {
+    if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
+      anyPlaying = true;
+    } else if (player.getState() == Shared::Protocol::PlayerState::READY) {
+    } else {
+      allReady = false;
+    }
+  }
+
+  if (allReady && !anyPlaying) {
+    for (auto &[_, player] : m_players) {
+      if (player.getState() == Shared::Protocol::PlayerState::READY) {
+        player.setState(Shared::Protocol::PlayerState::PLAYING);
+      }
+    }
+    m_broadcaster.broadcastGameState(m_step);
+    return;
+  }
+
+  m_tick++;
+  {
+    TRACE_SCOPE("updateEntities");
+    Metrics::ScopedTimer timer(m_metrics, Metrics::Histogram::ENTITIES_PHASE);
+    updateEntities();
+  }
+  if (m_threadPool && m_players.size() >= PARALLEL_PLAYERS_THRESHOLD) {
+    simulatePlayersParallel();
+  } else {
+    {
+      TRACE_SCOPE("updatePlayers");
+      Metrics::ScopedTimer timer(m_metrics, Metrics::Histogram::PLAYERS_PHASE);
+      updatePlayers();
+    }
+    {
+      TRACE_SCOPE("checkCollisions");
+      Metrics::ScopedTimer timer(m_metrics,
+                                 Metrics::Histogram::COLLISIONS_PHASE);
+      checkCollisions();
+    }
+  }
+  if (isSnapshotTick()) {
+    TRACE_SCOPE("broadcastGameState");
+    Metrics::ScopedTimer timer(m_metrics, Metrics::Histogram::BROADCAST_PHASE);
+    m_broadcaster.broadcastGameState(m_step);
+  }
+  checkGameEnd();
+}
+
+void Jetpack::Server::Match::updateEntities() {
+  if (m_entities.size() == 0) {
+    return;
+  }
+
+  m_entityTargets.clear();
+  for (const auto &[_, player] : m_players) {
+    if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
+      m_entityTargets.push_back(player.getPosition());
+    }
+  }
+
+  m_entities.update(m_tick, static_cast<float>(m_map.height),
+                    m_entityTargets,
+                    ENTITY_VIEW_BEHIND + ENTITY_UPDATE_MARGIN,
+                    ENTITY_VIEW_AHEAD + ENTITY_UPDATE_MARGIN);
+  m_entityHash.rebuild(m_entities, m_entities.getNearby());
+
+  if (m_entityTargets.empty() || !isSnapshotTick()) {
+    return;
+  }
+  m_broadcaster.broadcastEntities(m_entities, ENTITY_VIEW_BEHIND,
+                                  ENTITY_VIEW_AHEAD);
+}
+
+void Jetpack::Server::Match::updatePlayers() {
+  for (auto &[_, player] : m_players) {
+    updatePlayer(player);
+  }
+}
+
+void Jetpack::Server::Match::checkCollisions() {
+  CollisionEvent event;
+
+  for (auto &[_, player] : m_players) {
+    if (detectCollision(player, event)) {
+      resolveCollision(event);
+    }
+  }
+}
+
+void Jetpack::Server::Match::simulatePlayersParallel() {
+  m_tickPlayers.clear();
+  for (auto &[_, player] : m_players) {
+    m_tickPlayers.push_back(&player);
+  }
+
+  const size_t taskCount = m_collisionEvents.size();
+  const size_t chunkSize = (m_tickPlayers.size() + taskCount - 1) / taskCount;
+
+  // Workers must not grow their event lists: the match arena is not
+  // thread-safe, and a player yields at most one event per tick.
+  for (auto &events : m_collisionEvents) {
+    events.reserve(chunkSize);
+  }
+
+  auto integrate = [this, chunkSize](size_t task) {
+    TRACE_SCOPE("updatePlayers chunk");
+    size_t begin = std::min(task * chunkSize, m_tickPlayers.size());
+    size_t end = std::min(begin + chunkSize, m_tickPlayers.size());
+    for (size_t i = begin; i < end; i++) {
+      updatePlayer(*m_tickPlayers[i]);
+    }
+  };
+  {
+    TRACE_SCOPE("updatePlayers");
+    Metrics::ScopedTimer timer(m_metrics, Metrics::Histogram::PLAYERS_PHASE);
+    m_threadPool->parallelFor(taskCount, integrate);
+  }
+
+  auto detect = [this, chunkSize](size_t task) {
+    TRACE_SCOPE("checkCollisions chunk");
+    size_t begin = std::min(task * chunkSize, m_tickPlayers.size());
+    size_t end = std::min(begin + chunkSize, m_tickPlayers.size());
+    auto &events = m_collisionEvents[task];
+    CollisionEvent event;
+
+    events.clear();
+    for (size_t i = begin; i < end; i++) {
+      if (detectCollision(*m_tickPlayers[i], event)) {
+        events.push_back(event);
+      }
+    }
+  };
+  TRACE_SCOPE("checkCollisions");
+  Metrics::ScopedTimer timer(m_metrics, Metrics::Histogram::COLLISIONS_PHASE);
+  m_threadPool->parallelFor(taskCount, detect);
+
+  // Chunks are contiguous slices of the serial iteration order, so replaying
+  // them in chunk order resolves contested coins exactly like the serial path.
+  for (const auto &events : m_collisionEvents) {
+    for (const auto &event : events) {
+      resolveCollision(event);
+    }
+  }
+}
+
+void Jetpack::Server::Match::updatePlayer(
+    Shared::Protocol::Player &player) const {
+  if (player.getState() != Shared::Protocol::PlayerState::PLAYING) {
+    return;
+  }
+
+  Shared::Physics::applyPhysics(player);
+  Shared::Physics::checkBounds(player, m_map);
+
+  if (player.getPosition().x >= m_map.width) {
+    player.setState(Shared::Protocol::PlayerState::FINISHED);
+  }
+}
+
+bool Jetpack::Server::Match::detectCollision(
+    Shared::Protocol::Player &player, CollisionEvent &event) const {
+  if (player.getState() != Shared::Protocol::PlayerState::PLAYING) {
+    return false;
+  }
+
+  int cell_x = static_cast<int>(player.getPosition().x);
+  int cell_y = static_cast<int>(player.getPosition().y);
+
+  if (cell_x < 0 || cell_x >= m_map.width || cell_y < 0 ||
+      cell_y >= m_map.height) {
+    return false;
+  }
+
+  Shared::Protocol::TileType tile = m_map.tiles[cell_y][cell_x];
+  if (tile != Shared::Protocol::TileType::EMPTY) {
+    event = {&player, cell_x, cell_y, tile};
+    return true;
+  }
+
+  const Shared::Protocol::Position position = player.getPosition();
+  for (uint32_t id : m_entityHash.getCandidates(position.x, position.y)) {
+    if (m_entities.isLethalAt(id, position.x, position.y)) {
+      event = {&player, cell_x, cell_y,
+               Shared::Protocol::TileType::ELECTRICSQUARE};
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void Jetpack::Server::Match::resolveCollision(
+    const CollisionEvent &event) {
+  Shared::Protocol::Player &player = *event.player;
+
+  if (event.tile == Shared::Protocol::TileType::COIN) {
+    if (m_map.tiles[event.y][event.x] != Shared::Protocol::TileType::COIN) {
+      return;
+    }
+    player.setScore(player.getScore() + 1);
+    m_map.tiles[event.y][event.x] = Shared::Protocol::TileType::EMPTY;
+
+    m_broadcaster.broadcastCoinCollected(player.getId(), event.x, event.y);
+
+  } else if (event.tile == Shared::Protocol::TileType::ELECTRICSQUARE) {
+    player.setState(Shared::Protocol::PlayerState::DEAD);
+
+    m_broadcaster.broadcastPlayerDeath(player.getId());
+  }
+}
+
+void Jetpack::Server::Match::checkGameEnd() {
+  bool allFinished = true;
+  bool anyDead = false;
+  int activePlayersCount = 0;
+
+  for (const auto &[_, player] : m_players) {
+    if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
+      allFinished = false;
+      activePlayersCount++;
+    } else if (player.getState() == Shared::Protocol::PlayerState::FINISHED) {
+      activePlayersCount++;
+    } else if (player.getState() == Shared::Protocol::PlayerState::DEAD) {
+      anyDead = true;
+    }
+  }
+
+  if ((allFinished && activePlayersCount > 0) || anyDead ||
+      (activePlayersCount < MIN_PLAYERS && m_players.size() >= MIN_PLAYERS)) {
+    m_gameState = Shared::Protocol::GameState::GAME_OVER;
+
+    int winnerId = -1;
+    int highestScore = -1;
+
+    for (const auto &[_, player] : m_players) {
+      if (anyDead && player.getState() != Shared::Protocol::PlayerState::DEAD) {
+        winnerId = player.getId();
+        break;
+      }
+
+      if (player.getScore() > highestScore) {
+        highestScore = player.getScore();
+        winnerId = player.getId();
+      }
+    }
+
+    m_winnerId = winnerId;
+    m_broadcaster.broadcastGameOver(winnerId);
+  }
+}
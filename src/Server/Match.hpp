@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../Shared/Protocol.hpp"
+#include "Broadcaster.hpp"
+#include "EntityStore.hpp"
+#include "MatchServices.hpp"
+#include "Metrics.hpp"
+#include "ServerConfig.hpp"
+#include "SpatialHash.hpp"
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+namespace Jetpack::Server {
+class MatchRecording;
+
+struct EntitySpawn {
+  Shared::Protocol::EntityType type = Shared::Protocol::EntityType::ZAPPER;
+  float x = 0.0f;
+  float y = 0.0f;
+};
+
+// Load shedding applied by the server while ticks overrun their budget.
+struct MatchDegradation {
+  uint32_t snapshotInterval = 1;
+  bool ownerOnlyEvents = false;
+};
+
+struct MapTemplate {
+  Shared::Protocol::GameMap map;
+  std::vector<EntitySpawn> entities;
+};
+
+class Match {
+public:
+  // Wall-clock length of one simulation step when run by the server.
+  static constexpr auto TICK_PERIOD = Shared::Protocol::TICK_PERIOD;
+  // From this many players a step spreads them over the thread pool.
+  static constexpr size_t PARALLEL_PLAYERS_THRESHOLD = 32;
+
+  Match(std::pmr::memory_resource *resource, const MapTemplate &mapTemplate,
+        const ServerConfig &config, const MatchServices &services,
+        uint32_t id = 0);
+
+  Match(const Match &) = delete;
+  Match &operator=(const Match &) = delete;
+
+  int addPlayer(int clientSocket);
+  void removePlayer(int clientSocket);
+  void setPlayerInput(int clientSocket, bool jetpacking, uint16_t sequence);
+  // Schedules an input edge the client timestamped with the step it expected
+  // it to apply to. Edges keep their spacing and take effect at least one
+  // step apart, so a tap shorter than a step still moves the player.
+  void queuePlayerInput(int clientSocket, bool jetpacking, uint16_t sequence,
+                        uint32_t step);
+
+  void checkGameStart();
+  void updateGameState();
+  void forceEnd();
+  void setDegradation(const MatchDegradation &degradation);
+  void setRecording(MatchRecording *recording) { m_recording = recording; }
+
+  uint32_t getId() const { return m_id; }
+  Shared::Protocol::GameState getGameState() const { return m_gameState; }
+  uint32_t getTick() const { return m_tick; }
+  uint32_t getStep() const { return m_step; }
+  int getWinnerId() const { return m_winnerId; }
+  bool isWarmedUp() const { return m_tick > WARMUP_TICKS; }
+  const PlayerMap &getPlayers() const { return m_players; }
+  const Shared::Protocol::GameMap &getMap() const { return m_map; }
+  const EntityStore &getEntities() const { return m_entities; }
+
+private:
+  friend struct MatchBenchmarkAccess;
+
+  static constexpr int MIN_PLAYERS = 2;
+  static constexpr float ENTITY_VIEW_BEHIND = 4.0f;
+  static constexpr float ENTITY_VIEW_AHEAD = 64.0f;
+  // Entities are simulated this much beyond a player's view, so that those
+  // reaching into it, like a wide laser, are current.
+  static constexpr float ENTITY_UPDATE_MARGIN = 4.0f;
+  static constexpr uint32_t WARMUP_TICKS = 2;
+  static constexpr uint32_t MAX_INPUT_LEAD_STEPS = 30;
+  static constexpr size_t MAX_QUEUED_INPUTS_PER_PLAYER = 64;
+
+  struct QueuedInput {
+    int clientSocket = -1;
+    uint32_t step = 0;
+    // How many steps late the first edge of this burst arrived; later
+    // edges are shifted by the same amount.
+    uint32_t delay = 0;
+    uint16_t sequence = 0;
+    bool jetpacking = false;
+  };
+
+  struct CollisionEvent {
+    Shared::Protocol::Player *player = nullptr;
+    int x = 0;
+    int y = 0;
+    Shared::Protocol::TileType tile = Shared::Protocol::TileType::EMPTY;
+  };
+
+  void applyQueuedInputs();
+  void updateEntities();
+  void updatePlayers();
+  void checkCollisions();
+  void simulatePlayersParallel();
+  void checkGameEnd();
+  bool isSnapshotTick() const {
+    return m_tick % m_degradation.snapshotInterval == 0;
+  }
+
+  void updatePlayer(Shared::Protocol::Player &player) const;
+  bool detectCollision(Shared::Protocol::Player &player,
+                       CollisionEvent &event) const;
+  void resolveCollision(const CollisionEvent &event);
+
+  uint32_t m_id;
+  int m_playersPerMatch;
+  ThreadPool *m_threadPool;
+  Metrics *m_metrics;
+
+  Shared::Protocol::GameMap m_map;
+  PlayerMap m_players;
+  Broadcaster m_broadcaster;
+
+  EntityStore m_entities;
+  SpatialHash m_entityHash;
+  std::pmr::vector<Shared::Protocol::Position> m_entityTargets;
+  std::pmr::vector<QueuedInput> m_queuedInputs;
+  // By socket, the last step whose queued edges were looked at.
+  std::pmr::unordered_map<int, uint32_t> m_inputCheckSteps;
+  uint32_t m_tick = 0;
+  uint32_t m_step = 0;
+  int m_winnerId = -1;
+  MatchRecording *m_recording = nullptr;
+  MatchDegradation m_degradation;
+
+  std::pmr::vector<Shared::Protocol::Player *> m_tickPlayers;
+  std::pmr::vector<std::pmr::vector<CollisionEvent>> m_collisionEvents;
+
+  Shared::Protocol::GameState m_gameState =
+      Shared::Protocol::GameState::WAITING_FOR_PLAYERS;
+};
+} // namespace Jetpack::Server
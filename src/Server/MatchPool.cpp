@@ -0,0 +1,41 @@
+#include "MatchPool.hpp"
+#include <algorithm>
+
+Jetpack::Server::Match *
+Jetpack::Server::MatchPool::acquire(const MapTemplate &mapTemplate) {
+  std::unique_ptr<Slot> slot;
+
+  if (m_idleSlots.empty()) {
+    slot = std::make_unique<Slot>();
+  } else {
+    slot = std::move(m_idleSlots.back());
+    m_idleSlots.pop_back();
+  }
+
+  slot->match.emplace(&slot->arena, mapTemplate, m_config, m_services,
+                      m_nextMatchId++);
+  m_activeSlots.push_back(std::move(slot));
+  return &*m_activeSlots.back()->match;
+}
+
+void Jetpack::Server::MatchPool::release(Match *match) {
+  auto it = std::find_if(m_activeSlots.begin(), m_activeSlots.end(),
+                         [match](const auto &slot) {
+                           return &*slot->match == match;
+                         });
+  if (it == m_activeSlots.end()) {
+    return;
+  }
+
+  std::unique_ptr<Slot> slot = std::move(*it);
+  m_activeSlots.erase(it);
+
+  // Every container of the match lives in the arena, so destroying the match
+  // frees nothing individually and the whole arena is dropped at once.
+  slot->match.reset();
+  slot->arena.release();
+
+  if (m_idleSlots.size() < MAX_IDLE_SLOTS) {
+    m_idleSlots.push_back(std::move(slot));
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Match.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace Jetpack::Server {
+class MatchPool {
+public:
+  MatchPool(const ServerConfig &config, const MatchServices &services)
+      : m_config(config), m_services(services) {}
+
+  Match *acquire(const MapTemplate &mapTemplate);
+  void release(Match *match);
+
+private:
+  static constexpr size_t ARENA_SIZE = 256 * 1024;
+  static constexpr size_t MAX_IDLE_SLOTS = 16;
+
+  struct Slot {
+    Slot()
+        : buffer(std::make_unique<std::byte[]>(ARENA_SIZE)),
+          arena(buffer.get(), ARENA_SIZE) {}
+
+    std::unique_ptr<std::byte[]> buffer;
+    std::pmr::monotonic_buffer_resource arena;
+    std::optional<Match> match;
+  };
+
+  const ServerConfig &m_config;
+  MatchServices m_services;
+  uint32_t m_nextMatchId = 1;
+
+  std::vector<std::unique_ptr<Slot>> m_activeSlots;
+  std::vector<std::unique_ptr<Slot>> m_idleSlots;
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,176 @@
+#include "MatchRecording.hpp"
+#include "../Shared/Exceptions.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+bool Jetpack::Server::MatchRecording::PlayerResult::operator==(
+    const PlayerResult &other) const {
+  return id == other.id && score == other.score && x == other.x &&
+         y == other.y && state == other.state;
+}
+
+Jetpack::Server::MatchRecording::MatchRecording(const MapTemplate &mapTemplate,
+                                                int playersPerMatch,
+                                                uint32_t matchId)
+    : m_mapTemplate(mapTemplate), m_playersPerMatch(playersPerMatch),
+      m_matchId(matchId) {}
+
+void Jetpack::Server::MatchRecording::record(uint32_t step, EventType type,
+                                             int key, uint8_t value) {
+  Event event;
+  event.step = step;
+  event.key = key;
+  event.type = type;
+  event.value = value;
+  m_events.push_back(event);
+}
+
+void Jetpack::Server::MatchRecording::recordResult(const Match &match) {
+  m_steps = match.getStep();
+  m_winnerId = match.getWinnerId();
+  m_results = collectResults(match);
+}
+
+std::vector<Jetpack::Server::MatchRecording::PlayerResult>
+Jetpack::Server::MatchRecording::collectResults(const Match &match) {
+  std::vector<PlayerResult> results;
+  for (const auto &[_, player] : match.getPlayers()) {
+    PlayerResult result;
+    result.id = player.getId();
+    result.score = player.getScore();
+    result.x = player.getPosition().x;
+    result.y = player.getPosition().y;
+    result.state = static_cast<uint8_t>(player.getState());
+    results.push_back(result);
+  }
+  std::sort(results.begin(), results.end(),
+            [](const auto &a, const auto &b) { return a.id < b.id; });
+  return results;
+}
+
+void Jetpack::Server::MatchRecording::save(const std::string &path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw Jetpack::Shared::Exceptions::RecordingException("Failed to open " +
+                                                          path);
+  }
+
+  const Shared::Protocol::GameMap &map = m_mapTemplate.map;
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.matchId = m_matchId;
+  header.playersPerMatch = m_playersPerMatch;
+  header.width = map.width;
+  header.height = map.height;
+  header.entityCount = m_mapTemplate.entities.size();
+  header.eventCount = m_events.size();
+  header.resultCount = m_results.size();
+  header.steps = m_steps;
+  header.winnerId = m_winnerId;
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  std::vector<uint8_t> row(map.width);
+  for (int y = 0; y < map.height; y++) {
+    for (int x = 0; x < map.width; x++) {
+      row[x] = static_cast<uint8_t>(map.tiles[y][x]);
+    }
+    file.write(reinterpret_cast<const char *>(row.data()), row.size());
+  }
+
+  for (const EntitySpawn &spawn : m_mapTemplate.entities) {
+    EntityRecord entity;
+    entity.x = spawn.x;
+    entity.y = spawn.y;
+    entity.type = static_cast<uint8_t>(spawn.type);
+    file.write(reinterpret_cast<const char *>(&entity), sizeof(entity));
+  }
+
+  file.write(reinterpret_cast<const char *>(m_events.data()),
+             m_events.size() * sizeof(Event));
+  file.write(reinterpret_cast<const char *>(m_results.data()),
+             m_results.size() * sizeof(PlayerResult));
+
+  if (!file) {
+    throw Jetpack::Shared::Exceptions::RecordingException(
+        "Failed to write " + path);
+  }
+}
+
+Jetpack::Server::MatchRecording
+Jetpack::Server::MatchRecording::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw Jetpack::Shared::Exceptions::RecordingException("Failed to open " +
+                                                          path);
+  }
+
+  FileHeader header;
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+    throw Jetpack::Shared::Exceptions::RecordingException(
+        path + " is not a match recording");
+  }
+
+  // Sizes come from the file, so check them against what is left of it
+  // before allocating anything.
+  const std::streampos bodyStart = file.tellg();
+  file.seekg(0, std::ios::end);
+  const uint64_t remaining = file.tellg() - bodyStart;
+  file.seekg(bodyStart);
+  if (header.width <= 0 || header.height <= 0 ||
+      header.playersPerMatch <= 0) {
+    throw Jetpack::Shared::Exceptions::RecordingException(
+        path + " has an invalid header");
+  }
+  const uint64_t expected =
+      uint64_t{static_cast<uint32_t>(header.width)} *
+          static_cast<uint32_t>(header.height) +
+      uint64_t{header.entityCount} * sizeof(EntityRecord) +
+      uint64_t{header.eventCount} * sizeof(Event) +
+      uint64_t{header.resultCount} * sizeof(PlayerResult);
+  if (expected > remaining) {
+    throw Jetpack::Shared::Exceptions::RecordingException(path +
+                                                          " is truncated");
+  }
+
+  MatchRecording recording;
+  recording.m_matchId = header.matchId;
+  recording.m_playersPerMatch = header.playersPerMatch;
+  recording.m_steps = header.steps;
+  recording.m_winnerId = header.winnerId;
+
+  Shared::Protocol::GameMap &map = recording.m_mapTemplate.map;
+  map.width = header.width;
+  map.height = header.height;
+  std::vector<uint8_t> row(map.width);
+  for (int y = 0; y < map.height; y++) {
+    file.read(reinterpret_cast<char *>(row.data()), row.size());
+    map.tiles.emplace_back();
+    for (uint8_t tile : row) {
+      map.tiles.back().push_back(static_cast<Shared::Protocol::TileType>(tile));
+    }
+  }
+
+  for (uint32_t i = 0; i < header.entityCount; i++) {
+    EntityRecord entity;
+    file.read(reinterpret_cast<char *>(&entity), sizeof(entity));
+    recording.m_mapTemplate.entities.push_back(
+        {static_cast<Shared::Protocol::EntityType>(entity.type), entity.x,
+         entity.y});
+  }
+
+  recording.m_events.resize(header.eventCount);
+  file.read(reinterpret_cast<char *>(recording.m_events.data()),
+            recording.m_events.size() * sizeof(Event));
+  recording.m_results.resize(header.resultCount);
+  file.read(reinterpret_cast<char *>(recording.m_results.data()),
+            recording.m_results.size() * sizeof(PlayerResult));
+
+  if (!file) {
+    throw Jetpack::Shared::Exceptions::RecordingException(path +
+                                                          " is truncated");
+  }
+  return recording;
+}
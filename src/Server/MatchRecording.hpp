@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Match.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Jetpack::Server {
+// Everything needed to re-simulate a match: its map, the order in which
+// players joined and left, and every change of jetpack input, each stamped
+// with the simulation step it preceded. The final player states are kept
+// so that a replay can check it reached the same outcome.
+class MatchRecording {
+public:
+  enum class EventType : uint8_t { JOIN = 0, LEAVE = 1, INPUT = 2, END = 3 };
+
+  struct Event {
+    uint32_t step = 0;
+    int32_t key = -1;
+    EventType type = EventType::JOIN;
+    uint8_t value = 0;
+    uint8_t reserved[2] = {};
+  };
+
+  struct PlayerResult {
+    int32_t id = -1;
+    int32_t score = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+    uint8_t state = 0;
+    uint8_t reserved[3] = {};
+
+    bool operator==(const PlayerResult &other) const;
+  };
+
+  static constexpr char FILE_MAGIC[8] = {'J', 'P', 'K', 'R', 'E', 'C', '1', 0};
+
+  MatchRecording() = default;
+  MatchRecording(const MapTemplate &mapTemplate, int playersPerMatch,
+                 uint32_t matchId);
+
+  void record(uint32_t step, EventType type, int key, uint8_t value = 0);
+  void recordResult(const Match &match);
+
+  void save(const std::string &path) const;
+  static MatchRecording load(const std::string &path);
+
+  // Results sorted by player id, in the same form recordResult() stores.
+  static std::vector<PlayerResult> collectResults(const Match &match);
+
+  const MapTemplate &getMapTemplate() const { return m_mapTemplate; }
+  int getPlayersPerMatch() const { return m_playersPerMatch; }
+  uint32_t getMatchId() const { return m_matchId; }
+  uint32_t getSteps() const { return m_steps; }
+  int getWinnerId() const { return m_winnerId; }
+  const std::vector<Event> &getEvents() const { return m_events; }
+  const std::vector<PlayerResult> &getResults() const { return m_results; }
+
+private:
+  struct FileHeader {
+    char magic[8] = {};
+    uint32_t matchId = 0;
+    int32_t playersPerMatch = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    uint32_t entityCount = 0;
+    uint32_t eventCount = 0;
+    uint32_t resultCount = 0;
+    uint32_t steps = 0;
+    int32_t winnerId = -1;
+  };
+
+  struct EntityRecord {
+    float x = 0.0f;
+    float y = 0.0f;
+    uint8_t type = 0;
+    uint8_t reserved[3] = {};
+  };
+
+  MapTemplate m_mapTemplate;
+  int m_playersPerMatch = 0;
+  uint32_t m_matchId = 0;
+  uint32_t m_steps = 0;
+  int m_winnerId = -1;
+  std::vector<Event> m_events;
+  std::vector<PlayerResult> m_results;
+};
+} // namespace Jetpack::Server
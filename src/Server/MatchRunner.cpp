@@ -0,0 +1,45 @@
+#include "MatchRunner.hpp"
+#include "../Shared/Exceptions.hpp"
+#include "AllocationCounter.hpp"
+#include "ThreadPool.hpp"
+#include <format>
+
+Jetpack::Server::Match *
+Jetpack::Server::MatchRunner::createMatch(const MapTemplate &mapTemplate) {
+  Match *match = m_pool.acquire(mapTemplate);
+  m_matches.push_back(match);
+  return match;
+}
+
+bool Jetpack::Server::MatchRunner::step(Match &match) {
+  match.setDegradation(m_degradation);
+
+  uint64_t allocationsBefore = countTickAllocations();
+  match.updateGameState();
+  uint64_t allocations = countTickAllocations() - allocationsBefore;
+
+  if (AllocationCounter::ENABLED && allocations > 0 && match.isWarmedUp()) {
+    throw Jetpack::Shared::Exceptions::GameServerException(std::format(
+        "{} heap allocation(s) during steady-state tick {} of a match",
+        allocations, match.getTick()));
+  }
+
+  return match.getGameState() == Shared::Protocol::GameState::GAME_OVER;
+}
+
+uint64_t Jetpack::Server::MatchRunner::countTickAllocations() {
+  if (!AllocationCounter::ENABLED) {
+    return 0;
+  }
+  uint64_t allocations = AllocationCounter::getAllocationCount();
+  if (m_threadPool) {
+    allocations += m_threadPool->getWorkerAllocationCount();
+  }
+  return allocations;
+}
+
+void Jetpack::Server::MatchRunner::release(size_t index) {
+  Match *match = m_matches[index];
+  m_matches.erase(m_matches.begin() + index);
+  m_pool.release(match);
+}
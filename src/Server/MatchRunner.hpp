@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Match.hpp"
+#include "MatchPool.hpp"
+#include "MatchServices.hpp"
+#include "ServerConfig.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace Jetpack::Server {
+// Owns the running matches and advances them one step per tick. It knows
+// nothing about sockets or time: the game server drives it from its event
+// loop, offline tools from a virtual clock.
+class MatchRunner {
+public:
+  MatchRunner(const ServerConfig &config, const MatchServices &services)
+      : m_pool(config, services), m_threadPool(services.threadPool) {}
+
+  MatchRunner(const MatchRunner &) = delete;
+  MatchRunner &operator=(const MatchRunner &) = delete;
+
+  Match *createMatch(const MapTemplate &mapTemplate);
+  void setDegradation(const MatchDegradation &degradation) {
+    m_degradation = degradation;
+  }
+
+  // Steps every match once. Matches that are over afterwards are passed to
+  // onFinished and released when it returns.
+  template <typename OnFinished> void tick(OnFinished &&onFinished) {
+    for (size_t i = 0; i < m_matches.size(); i++) {
+      Match *match = m_matches[i];
+      if (step(*match)) {
+        onFinished(*match);
+        release(i);
+        i--;
+      }
+    }
+  }
+
+  const std::vector<Match *> &getMatches() const { return m_matches; }
+
+private:
+  bool step(Match &match);
+  // Allocations by the threads that run a tick: this one and the workers
+  // of the match thread pool.
+  uint64_t countTickAllocations();
+  void release(size_t index);
+
+  MatchPool m_pool;
+  ThreadPool *m_threadPool;
+  std::vector<Match *> m_matches;
+  MatchDegradation m_degradation;
+};
+} // namespace Jetpack::Server
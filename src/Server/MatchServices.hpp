@@ -0,0 +1,19 @@
+#pragma once
+
+namespace Jetpack::Shared {
+class PacketLogger;
+} // namespace Jetpack::Shared
+
+namespace Jetpack::Server {
+class Metrics;
+class ThreadPool;
+
+// Server-wide facilities shared by every match; any of them may be absent.
+struct MatchServices {
+  ThreadPool *threadPool = nullptr;
+  Shared::PacketLogger *packetLogger = nullptr;
+  Metrics *metrics = nullptr;
+  // Offline matches (replays, batch runs) simulate without sending anything.
+  bool offline = false;
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,174 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <format>
+#include <string_view>
+
+namespace {
+struct MetricInfo {
+  std::string_view name;
+  std::string_view help;
+};
+
+constexpr MetricInfo COUNTER_INFO[] = {
+    {"jetpack_received_bytes_total", "Bytes received from clients."},
+    {"jetpack_sent_bytes_total", "Bytes sent to clients."},
+    {"jetpack_received_packets_total", "Reads returning client data."},
+    {"jetpack_sent_packets_total", "Packets sent to clients."},
+    {"jetpack_connections_accepted_total", "Client connections accepted."},
+    {"jetpack_connections_closed_total", "Client connections closed."},
+    {"jetpack_ticks_total", "Server loop ticks."},
+    {"jetpack_tick_overruns_total", "Ticks that exceeded their time budget."},
+    {"jetpack_connections_rejected_total",
+     "Connections refused while new matches are paused under overload."},
+};
+
+constexpr MetricInfo GAUGE_INFO[] = {
+    {"jetpack_connected_clients", "Currently connected clients."},
+    {"jetpack_active_matches", "Matches waiting for players or in progress."},
+    {"jetpack_send_queue_bytes", "Unsent bytes queued across client sockets."},
+    {"jetpack_send_queue_max_bytes",
+     "Largest unsent byte count queued on a single client socket."},
+    {"jetpack_degradation_level",
+     "Number of overload degradation steps currently applied."},
+};
+
+constexpr std::string_view TICK_HISTOGRAM_NAME =
+    "jetpack_tick_duration_seconds";
+constexpr std::string_view PHASE_HISTOGRAM_NAME =
+    "jetpack_tick_phase_duration_seconds";
+constexpr std::string_view PHASE_NAMES[] = {
+    "", "entities", "players", "collisions", "broadcast", "network"};
+
+std::atomic<size_t> nextShardIndex{0};
+
+class TextWriter {
+public:
+  TextWriter(char *buffer, size_t capacity)
+      : m_buffer(buffer), m_capacity(capacity) {}
+
+  template <typename... Args>
+  void write(std::format_string<Args...> format, Args &&...args) {
+    auto result =
+        std::format_to_n(m_buffer + m_size, m_capacity - m_size, format,
+                         std::forward<Args>(args)...);
+    m_size += std::min<size_t>(result.size, m_capacity - m_size);
+  }
+
+  size_t size() const { return m_size; }
+
+private:
+  char *m_buffer;
+  size_t m_capacity;
+  size_t m_size = 0;
+};
+} // namespace
+
+Jetpack::Server::Metrics::Shard &
+Jetpack::Server::Metrics::getShard() noexcept {
+  thread_local const size_t shardIndex =
+      nextShardIndex.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+  return m_shards[shardIndex];
+}
+
+void Jetpack::Server::Metrics::add(Counter counter, uint64_t value) noexcept {
+  getShard().counters[static_cast<size_t>(counter)].fetch_add(
+      value, std::memory_order_relaxed);
+}
+
+void Jetpack::Server::Metrics::set(Gauge gauge, int64_t value) noexcept {
+  m_gauges[static_cast<size_t>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+void Jetpack::Server::Metrics::observe(
+    Histogram histogram, std::chrono::nanoseconds duration) noexcept {
+  const uint64_t durationNs = std::max<int64_t>(duration.count(), 0);
+  const auto bound =
+      std::lower_bound(BUCKET_BOUNDS_US.begin(), BUCKET_BOUNDS_US.end(),
+                       (durationNs + 999) / 1000);
+
+  HistogramData &data = getShard().histograms[static_cast<size_t>(histogram)];
+  data.buckets[bound - BUCKET_BOUNDS_US.begin()].fetch_add(
+      1, std::memory_order_relaxed);
+  data.sumNs.fetch_add(durationNs, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds
+Jetpack::Server::Metrics::getTotal(Histogram histogram) const noexcept {
+  uint64_t sumNs = 0;
+  for (const Shard &shard : m_shards) {
+    sumNs += shard.histograms[static_cast<size_t>(histogram)].sumNs.load(
+        std::memory_order_relaxed);
+  }
+  return std::chrono::nanoseconds(sumNs);
+}
+
+size_t Jetpack::Server::Metrics::render(char *buffer, size_t capacity) const {
+  TextWriter writer(buffer, capacity);
+
+  for (size_t i = 0; i < COUNTER_COUNT; i++) {
+    uint64_t total = 0;
+    for (const Shard &shard : m_shards) {
+      total += shard.counters[i].load(std::memory_order_relaxed);
+    }
+    writer.write("# HELP {} {}\n# TYPE {} counter\n{} {}\n",
+                 COUNTER_INFO[i].name, COUNTER_INFO[i].help,
+                 COUNTER_INFO[i].name, COUNTER_INFO[i].name, total);
+  }
+
+  for (size_t i = 0; i < GAUGE_COUNT; i++) {
+    writer.write("# HELP {} {}\n# TYPE {} gauge\n{} {}\n", GAUGE_INFO[i].name,
+                 GAUGE_INFO[i].help, GAUGE_INFO[i].name, GAUGE_INFO[i].name,
+                 m_gauges[i].load(std::memory_order_relaxed));
+  }
+
+  for (size_t i = 0; i < HISTOGRAM_COUNT; i++) {
+    const bool isPhase = i != static_cast<size_t>(Histogram::TICK);
+    const std::string_view name =
+        isPhase ? PHASE_HISTOGRAM_NAME : TICK_HISTOGRAM_NAME;
+
+    if (i <= static_cast<size_t>(Histogram::ENTITIES_PHASE)) {
+      writer.write("# HELP {} {}\n# TYPE {} histogram\n", name,
+                   isPhase ? "Time spent in each phase of a tick."
+                           : "Time spent updating all matches in one tick.",
+                   name);
+    }
+
+    std::array<uint64_t, BUCKET_BOUNDS_US.size() + 1> buckets{};
+    uint64_t sumNs = 0;
+    for (const Shard &shard : m_shards) {
+      const HistogramData &data = shard.histograms[i];
+      for (size_t bucket = 0; bucket < buckets.size(); bucket++) {
+        buckets[bucket] += data.buckets[bucket].load(std::memory_order_relaxed);
+      }
+      sumNs += data.sumNs.load(std::memory_order_relaxed);
+    }
+
+    const std::string_view phaseLabel =
+        isPhase ? PHASE_NAMES[i] : std::string_view();
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < buckets.size(); bucket++) {
+      cumulative += buckets[bucket];
+      if (bucket < BUCKET_BOUNDS_US.size()) {
+        writer.write("{}_bucket{{{}{}{}le=\"{}\"}} {}\n", name,
+                     isPhase ? "phase=\"" : "", phaseLabel,
+                     isPhase ? "\"," : "",
+                     BUCKET_BOUNDS_US[bucket] / 1e6, cumulative);
+      } else {
+        writer.write("{}_bucket{{{}{}{}le=\"+Inf\"}} {}\n", name,
+                     isPhase ? "phase=\"" : "", phaseLabel,
+                     isPhase ? "\"," : "", cumulative);
+      }
+    }
+
+    if (isPhase) {
+      writer.write("{}_sum{{phase=\"{}\"}} {}\n{}_count{{phase=\"{}\"}} {}\n",
+                   name, phaseLabel, sumNs / 1e9, name, phaseLabel,
+                   cumulative);
+    } else {
+      writer.write("{}_sum {}\n{}_count {}\n", name, sumNs / 1e9, name,
+                   cumulative);
+    }
+  }
+
+  return writer.size();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Jetpack::Server {
+// Counters and histograms are sharded per thread so that recording is a
+// single uncontended relaxed atomic add; shards are only summed on scrape.
+class Metrics {
+public:
+  enum class Counter : size_t {
+    BYTES_RECEIVED,
+    BYTES_SENT,
+    PACKETS_RECEIVED,
+    PACKETS_SENT,
+    CONNECTIONS_ACCEPTED,
+    CONNECTIONS_CLOSED,
+    TICKS,
+    TICK_OVERRUNS,
+    CONNECTIONS_REJECTED,
+    COUNT
+  };
+
+  enum class Gauge : size_t {
+    CONNECTED_CLIENTS,
+    ACTIVE_MATCHES,
+    SEND_QUEUE_BYTES,
+    SEND_QUEUE_MAX_BYTES,
+    DEGRADATION_LEVEL,
+    COUNT
+  };
+
+  enum class Histogram : size_t {
+    TICK,
+    ENTITIES_PHASE,
+    PLAYERS_PHASE,
+    COLLISIONS_PHASE,
+    BROADCAST_PHASE,
+    NETWORK_PHASE,
+    COUNT
+  };
+
+  class ScopedTimer {
+  public:
+    ScopedTimer(Metrics *metrics, Histogram histogram)
+        : m_metrics(metrics), m_histogram(histogram),
+          m_start(metrics ? std::chrono::steady_clock::now()
+                          : std::chrono::steady_clock::time_point()) {}
+    ~ScopedTimer() {
+      if (m_metrics) {
+        m_metrics->observe(m_histogram,
+                           std::chrono::steady_clock::now() - m_start);
+      }
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  private:
+    Metrics *m_metrics;
+    Histogram m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  void add(Counter counter, uint64_t value = 1) noexcept;
+  void set(Gauge gauge, int64_t value) noexcept;
+  void observe(Histogram histogram, std::chrono::nanoseconds duration) noexcept;
+
+  // Total time observed so far, summed over all shards.
+  std::chrono::nanoseconds getTotal(Histogram histogram) const noexcept;
+
+  // Writes the Prometheus text exposition into buffer without allocating and
+  // returns the number of bytes used.
+  size_t render(char *buffer, size_t capacity) const;
+
+private:
+  static constexpr size_t SHARD_COUNT = 16;
+  static constexpr std::array<uint64_t, 12> BUCKET_BOUNDS_US = {
+      10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+
+  static constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+  static constexpr size_t GAUGE_COUNT = static_cast<size_t>(Gauge::COUNT);
+  static constexpr size_t HISTOGRAM_COUNT =
+      static_cast<size_t>(Histogram::COUNT);
+
+  struct HistogramData {
+    std::array<std::atomic<uint64_t>, BUCKET_BOUNDS_US.size() + 1> buckets{};
+    std::atomic<uint64_t> sumNs{0};
+  };
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    std::array<HistogramData, HISTOGRAM_COUNT> histograms{};
+  };
+
+  Shard &getShard() noexcept;
+
+  std::array<Shard, SHARD_COUNT> m_shards{};
+  std::array<std::atomic<int64_t>, GAUGE_COUNT> m_gauges{};
+};
+} // namespace Jetpack::Server
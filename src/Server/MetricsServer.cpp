@@ -0,0 +1,106 @@
+#include "MetricsServer.hpp"
+#include "../Shared/Exceptions.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <format>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+Jetpack::Server::MetricsServer::MetricsServer(const Metrics &metrics,
+                                              int port)
+    : m_metrics(metrics) {
+  m_serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (m_serverSocket < 0) {
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Failed to create metrics socket");
+  }
+
+  int opt = 1;
+  setsockopt(m_serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+  struct sockaddr_in address {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+
+  if (bind(m_serverSocket, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+      listen(m_serverSocket, SOMAXCONN) < 0) {
+    close(m_serverSocket);
+    throw Jetpack::Shared::Exceptions::SocketException(
+        "Failed to listen on metrics port " + std::to_string(port));
+  }
+
+  m_thread = std::thread(&MetricsServer::serveLoop, this);
+}
+
+Jetpack::Server::MetricsServer::~MetricsServer() {
+  m_running = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  close(m_serverSocket);
+}
+
+void Jetpack::Server::MetricsServer::serveLoop() {
+  pollfd pfd = {m_serverSocket, POLLIN, 0};
+
+  while (m_running) {
+    if (poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0 || !(pfd.revents & POLLIN)) {
+      continue;
+    }
+
+    int clientSocket = accept(m_serverSocket, nullptr, nullptr);
+    if (clientSocket < 0) {
+      continue;
+    }
+
+    // Requests are served one at a time, so a connection that cannot be
+    // given a timeout is dropped rather than risk an idle one stalling
+    // every later scrape.
+    const timeval timeout = {REQUEST_TIMEOUT_MS / 1000,
+                             (REQUEST_TIMEOUT_MS % 1000) * 1000};
+    if (setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                   sizeof(timeout)) == 0 &&
+        setsockopt(clientSocket, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                   sizeof(timeout)) == 0) {
+      handleRequest(clientSocket);
+    }
+    close(clientSocket);
+  }
+}
+
+void Jetpack::Server::MetricsServer::handleRequest(int clientSocket) {
+  char request[1024];
+  ssize_t bytesRead = recv(clientSocket, request, sizeof(request) - 1, 0);
+  if (bytesRead <= 0) {
+    return;
+  }
+  request[bytesRead] = '\0';
+
+  const bool isMetrics = std::strncmp(request, "GET /metrics ", 13) == 0 ||
+                         std::strncmp(request, "GET / ", 6) == 0;
+  size_t bodySize = 0;
+  if (isMetrics) {
+    bodySize = m_metrics.render(m_body.data(), m_body.size());
+  }
+
+  char header[256];
+  auto result = std::format_to_n(
+      header, sizeof(header),
+      "HTTP/1.1 {}\r\nContent-Type: text/plain; version=0.0.4\r\n"
+      "Content-Length: {}\r\nConnection: close\r\n\r\n",
+      isMetrics ? "200 OK" : "404 Not Found", bodySize);
+
+  send(clientSocket, header, result.out - header, MSG_NOSIGNAL);
+  size_t sent = 0;
+  while (sent < bodySize) {
+    ssize_t written =
+        send(clientSocket, m_body.data() + sent, bodySize - sent, MSG_NOSIGNAL);
+    if (written <= 0) {
+      break;
+    }
+    sent += written;
+  }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Metrics.hpp"
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace Jetpack::Server {
+// Serves Metrics in Prometheus text format on 127.0.0.1 from its own thread,
+// so a scrape never stalls the game loop.
+class MetricsServer {
+public:
+  MetricsServer(const Metrics &metrics, int port);
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer &) = delete;
+  MetricsServer &operator=(const MetricsServer &) = delete;
+
+private:
+  static constexpr int POLL_TIMEOUT_MS = 200;
+  static constexpr int REQUEST_TIMEOUT_MS = 1000;
+  static constexpr size_t BODY_CAPACITY = 32 * 1024;
+
+  void serveLoop();
+  void handleRequest(int clientSocket);
+
+  const Metrics &m_metrics;
+  int m_serverSocket = -1;
+
+  std::array<char, BODY_CAPACITY> m_body;
+
+  std::atomic<bool> m_running{true};
+  std::thread m_thread;
+};
+} // namespace Jetpack::Server
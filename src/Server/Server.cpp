@@ -1,37 +1,123 @@
 #include "Server.hpp"
 #include "../Shared/Exceptions.hpp"
-#include "Physics.hpp"
+#include "../Shared/PacketCodec.hpp"
+#include "../Shared/Trace.hpp"
+#include "Log.hpp"
+#include "MapLoader.hpp"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cstddef>
 #include <cstring>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <linux/sockios.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
 #include <sys/fcntl.h>
 #include <vector>
 
-Jetpack::Server::GameServer::GameServer(int port, const std::string &mapFile,
-                                        bool debugMode)
-    : m_port(port), m_mapFile(mapFile), m_debugMode(debugMode),
-      m_broadcaster(m_players, m_debugMode) {
+static const char *toString(Jetpack::Shared::Protocol::GameState state) {
+  switch (state) {
+  case Jetpack::Shared::Protocol::GameState::WAITING_FOR_PLAYERS:
+    return "waiting";
+  case Jetpack::Shared::Protocol::GameState::IN_PROGRESS:
+    return "in-progress";
+  case Jetpack::Shared::Protocol::GameState::GAME_OVER:
+    return "game-over";
+  }
+  return "unknown";
+}
+
+static const char *toString(Jetpack::Shared::Protocol::PlayerState state) {
+  switch (state) {
+  case Jetpack::Shared::Protocol::PlayerState::CONNECTED:
+    return "connected";
+  case Jetpack::Shared::Protocol::PlayerState::READY:
+    return "ready";
+  case Jetpack::Shared::Protocol::PlayerState::PLAYING:
+    return "playing";
+  case Jetpack::Shared::Protocol::PlayerState::DEAD:
+    return "dead";
+  case Jetpack::Shared::Protocol::PlayerState::FINISHED:
+    return "finished";
+  case Jetpack::Shared::Protocol::PlayerState::DISCONNECTED:
+    return "disconnected";
+  }
+  return "unknown";
+}
+
+static char toMapChar(Jetpack::Shared::Protocol::EntityType type) {
+  switch (type) {
+  case Jetpack::Shared::Protocol::EntityType::ZAPPER:
+    return 'Z';
+  case Jetpack::Shared::Protocol::EntityType::MISSILE:
+    return 'M';
+  case Jetpack::Shared::Protocol::EntityType::LASER:
+    return 'L';
+  }
+  return '?';
+}
+
+Jetpack::Server::GameServer::GameServer(const ServerConfig &config)
+    : m_config(config), m_port(config.port), m_mapFile(config.mapFile),
+      m_packetLogger(config.debugMode
+                         ? std::make_unique<Shared::PacketLogger>(
+                               config.packetLogFile)
+                         : nullptr),
+      m_threadPool(config.simulationThreads > 1
+                       ? std::make_unique<ThreadPool>(config.simulationThreads)
+                       : nullptr),
+      m_matchRunner(m_config, {m_threadPool.get(), m_packetLogger.get(),
+                               &m_metrics}),
+      m_watchdog(std::chrono::milliseconds(config.tickBudgetMs),
+                 config.degradationSteps, m_metrics) {
   if (!loadMap()) {
     throw Jetpack::Shared::Exceptions::MapLoaderException(
         "Failed to load map file: " + m_mapFile.string());
   }
+  encodeMapData();
   initializeSocket();
+
+  if (config.metricsPort > 0) {
+    m_metricsServer =
+        std::make_unique<MetricsServer>(m_metrics, config.metricsPort);
+  }
+
+  if (!config.adminSocketPath.empty()) {
+    m_adminServer = std::make_unique<AdminServer>(config.adminSocketPath);
+    registerAdminCommands();
+    m_pollfds.push_back({m_adminServer->getPollFd(), POLLIN, 0});
+  }
 }
 
 Jetpack::Server::GameServer::~GameServer() {
-  for (const auto &[playerSocket, _] : m_players) {
+  for (const auto &[playerSocket, _] : m_clientMatches) {
     close(playerSocket);
   }
   close(m_serverSocket);
 }
 
 void Jetpack::Server::GameServer::start() {
+  Shared::Trace::setThreadName("game loop");
+  auto nextTick = std::chrono::steady_clock::now();
+
+  // Socket events are handled as they arrive, but matches only advance on the
+  // fixed tick cadence so that game speed does not depend on traffic.
   while (m_running) {
-    int ready = poll(m_pollfds.data(), m_pollfds.size(), GAME_TICK_MS);
+    auto now = std::chrono::steady_clock::now();
+    int timeout = 0;
+    if (nextTick > now) {
+      timeout = std::chrono::ceil<std::chrono::milliseconds>(nextTick - now)
+                    .count();
+    }
+
+    int ready;
+    {
+      TRACE_SCOPE("poll");
+      ready = poll(m_pollfds.data(), m_pollfds.size(), timeout);
+    }
 
     if (ready < 0) {
       if (errno == EINTR)
@@ -39,62 +125,123 @@ void Jetpack::Server::GameServer::start() {
       break;
     }
 
-    handleSocketEvents();
-    updateGameState();
+    if (ready > 0) {
+      handleSocketEvents();
+    }
+
+    now = std::chrono::steady_clock::now();
+    if (now < nextTick) {
+      continue;
+    }
+
+    runTick();
+
+    nextTick += TICK_PERIOD;
+    if (now - nextTick > TICK_PERIOD * MAX_CATCH_UP_TICKS) {
+      nextTick = now;
+    }
   }
 }
 
-bool Jetpack::Server::GameServer::loadMap() {
-  std::ifstream file(m_mapFile);
-  if (!file.is_open()) {
-    return false;
+void Jetpack::Server::GameServer::runTick() {
+  const auto start = std::chrono::steady_clock::now();
+
+  m_matchRunner.setDegradation(m_watchdog.getMatchDegradation());
+  updateMatches();
+
+  if (start - m_lastSendQueueSample >= SEND_QUEUE_SAMPLE_INTERVAL) {
+    sampleSendQueues();
+    m_lastSendQueueSample = start;
   }
 
-  std::vector<std::string> lines;
-  std::string line;
-  while (std::getline(file, line)) {
-    if (!line.empty()) {
-      lines.push_back(line);
+  m_watchdog.recordTick(std::chrono::steady_clock::now() - start);
+}
+
+void Jetpack::Server::GameServer::updateMatches() {
+  TRACE_SCOPE("updateMatches");
+  Metrics::ScopedTimer timer(&m_metrics, Metrics::Histogram::TICK);
+  m_metrics.add(Metrics::Counter::TICKS);
+
+  m_matchRunner.tick([this](Match &match) { closeMatch(&match); });
+
+  m_metrics.set(Metrics::Gauge::ACTIVE_MATCHES,
+                m_matchRunner.getMatches().size());
+  m_metrics.set(Metrics::Gauge::CONNECTED_CLIENTS, m_clientMatches.size());
+}
+
+void Jetpack::Server::GameServer::sampleSendQueues() {
+  TRACE_SCOPE("sampleSendQueues");
+  int64_t totalQueued = 0;
+  int64_t maxQueued = 0;
+
+  for (const auto &[clientSocket, _] : m_clientMatches) {
+    int queued = 0;
+    if (ioctl(clientSocket, SIOCOUTQ, &queued) == 0) {
+      totalQueued += queued;
+      maxQueued = std::max<int64_t>(maxQueued, queued);
     }
   }
 
-  if (lines.empty()) {
-    return false;
+  m_metrics.set(Metrics::Gauge::SEND_QUEUE_BYTES, totalQueued);
+  m_metrics.set(Metrics::Gauge::SEND_QUEUE_MAX_BYTES, maxQueued);
+}
+
+void Jetpack::Server::GameServer::closeMatch(Match *match) {
+  for (const auto &[playerSocket, _] : match->getPlayers()) {
+    m_clientMatches.erase(playerSocket);
+    removePollfd(playerSocket);
   }
 
-  m_map.height = lines.size();
-  m_map.width = lines[0].length();
+  if (m_waitingMatch == match) {
+    m_waitingMatch = nullptr;
+  }
+  Log::write(LogLevel::INFO, "match {} closed after {} ticks", match->getId(),
+             match->getTick());
+  saveRecording(match);
+}
 
-  for (const auto &line : lines) {
-    if (line.length() != static_cast<size_t>(m_map.width)) {
-      return false;
-    }
+void Jetpack::Server::GameServer::saveRecording(Match *match) {
+  auto it = m_recordings.find(match);
+  if (it == m_recordings.end()) {
+    return;
   }
 
-  m_map.tiles.resize(m_map.height,
-                     std::vector<Shared::Protocol::TileType>(
-                         m_map.width, Shared::Protocol::TileType::EMPTY));
+  const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  const std::filesystem::path path =
+      std::filesystem::path(m_config.recordDirectory) /
+      std::format("match-{}-{}.jprec", now.count(), match->getId());
 
-  for (int y = 0; y < m_map.height; y++) {
-    for (int x = 0; x < m_map.width; x++) {
-      switch (lines[y][x]) {
-      case '_':
-        m_map.tiles[y][x] = Shared::Protocol::TileType::EMPTY;
-        break;
-      case 'c':
-        m_map.tiles[y][x] = Shared::Protocol::TileType::COIN;
-        break;
-      case 'e':
-        m_map.tiles[y][x] = Shared::Protocol::TileType::ELECTRICSQUARE;
-        break;
-      default:
-        m_map.tiles[y][x] = Shared::Protocol::TileType::EMPTY;
-        break;
-      }
+  try {
+    it->second->recordResult(*match);
+    it->second->save(path.string());
+    Log::write(LogLevel::INFO, "match {} recorded to {}", match->getId(),
+               path.string());
+  } catch (const Jetpack::Shared::Exceptions::RecordingException &e) {
+    Log::write(LogLevel::ERROR, "{}", e.what());
+  }
+  m_recordings.erase(it);
+}
+
+void Jetpack::Server::GameServer::removePollfd(int socket) {
+  for (size_t i = 0; i < m_pollfds.size(); i++) {
+    if (m_pollfds[i].fd == socket) {
+      close(socket);
+      m_metrics.add(Metrics::Counter::CONNECTIONS_CLOSED);
+      m_pollfds.erase(m_pollfds.begin() + i);
+      m_receiveBuffers.erase(socket);
+      break;
     }
   }
+}
+
+bool Jetpack::Server::GameServer::loadMap() {
+  std::ifstream file(m_mapFile);
+  if (!file.is_open()) {
+    return false;
+  }
 
-  return true;
+  return MapLoader::load(file, m_mapTemplate);
 }
 
 void Jetpack::Server::GameServer::initializeSocket() {
@@ -120,7 +267,7 @@ void Jetpack::Server::GameServer::initializeSocket() {
     throw Jetpack::Shared::Exceptions::SocketException("Failed to bind socket");
   }
 
-  if (listen(m_serverSocket, MAX_CLIENTS) < 0) {
+  if (listen(m_serverSocket, SOMAXCONN) < 0) {
     close(m_serverSocket);
     throw Jetpack::Shared::Exceptions::SocketException(
         "Failed to listen on socket");
@@ -131,7 +278,16 @@ void Jetpack::Server::GameServer::initializeSocket() {
 }
 
 void Jetpack::Server::GameServer::handleSocketEvents() {
+  TRACE_SCOPE("handleSocketEvents");
+  Metrics::ScopedTimer timer(&m_metrics, Metrics::Histogram::NETWORK_PHASE);
   for (size_t i = 0; i < m_pollfds.size(); i++) {
+    if (m_adminServer && m_pollfds[i].fd == m_adminServer->getPollFd()) {
+      if (m_pollfds[i].revents & POLLIN) {
+        m_adminServer->handleEvents();
+      }
+      continue;
+    }
+
     if (m_pollfds[i].revents & POLLIN) {
       if (m_pollfds[i].fd == m_serverSocket) {
         acceptNewClient();
@@ -148,68 +304,87 @@ void Jetpack::Server::GameServer::handleSocketEvents() {
 }
 
 void Jetpack::Server::GameServer::acceptNewClient() {
+  TRACE_SCOPE("acceptNewClient");
   struct sockaddr_in clientAddr;
   socklen_t addrLen = sizeof(clientAddr);
 
-  int clientSocket =
-      accept(m_serverSocket, (struct sockaddr *)&clientAddr, &addrLen);
-  if (clientSocket < 0) {
-    if (errno != EAGAIN && errno != EWOULDBLOCK) {
-    }
-    return;
+  // Drain the whole backlog: a connection burst would otherwise be admitted
+  // one client per poll wakeup.
+  int clientSocket;
+  while ((clientSocket = accept(m_serverSocket, (struct sockaddr *)&clientAddr,
+                                &addrLen)) >= 0) {
+    addClient(clientSocket);
+    addrLen = sizeof(clientAddr);
   }
+}
 
+void Jetpack::Server::GameServer::addClient(int clientSocket) {
   int flags = fcntl(clientSocket, F_GETFL, 0);
   fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
+  m_metrics.add(Metrics::Counter::CONNECTIONS_ACCEPTED);
+
+  if (!m_waitingMatch && !m_watchdog.isAcceptingMatches()) {
+    Log::write(LogLevel::DEBUG, "client {} refused: new matches paused",
+               clientSocket);
+    m_metrics.add(Metrics::Counter::CONNECTIONS_REJECTED);
+    close(clientSocket);
+    return;
+  }
 
   pollfd pfd = {clientSocket, POLLIN, 0};
   m_pollfds.push_back(pfd);
+  m_receiveBuffers.try_emplace(clientSocket);
 
-  int newPlayerId = m_players.size() + 1;
-  m_players.emplace(clientSocket,
-                    Shared::Protocol::Player(clientSocket, newPlayerId));
+  if (!m_waitingMatch) {
+    m_waitingMatch = m_matchRunner.createMatch(m_mapTemplate);
 
-  char client_ip[INET_ADDRSTRLEN];
-  inet_ntop(AF_INET, &clientAddr.sin_addr, client_ip, INET_ADDRSTRLEN);
+    if (!m_config.recordDirectory.empty()) {
+      auto recording = std::make_unique<MatchRecording>(
+          m_mapTemplate, m_config.playersPerMatch, m_waitingMatch->getId());
+      m_waitingMatch->setRecording(recording.get());
+      m_recordings[m_waitingMatch] = std::move(recording);
+    }
+  }
 
-  sendConnectResponse(clientSocket, newPlayerId);
+  Match *match = m_waitingMatch;
+  int newPlayerId = match->addPlayer(clientSocket);
+  m_clientMatches[clientSocket] = match;
+  Log::write(LogLevel::DEBUG, "client {} joined match {} as player {}",
+             clientSocket, match->getId(), newPlayerId);
+
+  sendConnectResponse(clientSocket, newPlayerId, match->getPlayers().size());
   sendMapData(clientSocket);
 
-  checkGameStart();
+  match->checkGameStart();
+  if (match->getGameState() !=
+      Shared::Protocol::GameState::WAITING_FOR_PLAYERS) {
+    Log::write(LogLevel::INFO, "match {} started with {} players",
+               match->getId(), match->getPlayers().size());
+    m_waitingMatch = nullptr;
+  }
 }
 
 void Jetpack::Server::GameServer::handleClientDisconnect(int clientSocket) {
-  auto it = m_players.find(clientSocket);
-  if (it != m_players.end()) {
-    m_players.erase(it);
-  }
-
-  for (size_t i = 0; i < m_pollfds.size(); i++) {
-    if (m_pollfds[i].fd == clientSocket) {
-      close(clientSocket);
-      m_pollfds.erase(m_pollfds.begin() + i);
-      break;
-    }
+  Log::write(LogLevel::DEBUG, "client {} disconnected", clientSocket);
+  auto it = m_clientMatches.find(clientSocket);
+  if (it != m_clientMatches.end()) {
+    it->second->removePlayer(clientSocket);
+    m_clientMatches.erase(it);
   }
 
-  if (m_gameState == Shared::Protocol::GameState::IN_PROGRESS) {
-    int activePlayers = 0;
-    for (const auto &[_, player] : m_players) {
-      if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
-        activePlayers++;
-      }
-    }
-
-    if (activePlayers < MIN_PLAYERS) {
-      m_gameState = Shared::Protocol::GameState::GAME_OVER;
-      m_broadcaster.broadcastGameOver();
-    }
-  }
+  removePollfd(clientSocket);
 }
 
 void Jetpack::Server::GameServer::handleClientData(int clientSocket) {
-  uint8_t buffer[BUFFER_SIZE];
-  ssize_t bytesRead = recv(clientSocket, buffer, BUFFER_SIZE, 0);
+  TRACE_SCOPE("handleClientData");
+  auto found = m_receiveBuffers.find(clientSocket);
+  if (found == m_receiveBuffers.end()) {
+    return;
+  }
+  ReceiveBuffer &receive = found->second;
+  uint8_t *readStart = receive.data.data() + receive.size;
+  ssize_t bytesRead =
+      recv(clientSocket, readStart, receive.data.size() - receive.size, 0);
 
   if (bytesRead <= 0) {
     if (bytesRead == 0 ||
@@ -219,17 +394,52 @@ void Jetpack::Server::GameServer::handleClientData(int clientSocket) {
     return;
   }
 
-  if (m_debugMode) {
-    std ::cout << std::format(
-        "Debug: Received {} bytes from client {} - Buffer: ", bytesRead,
-        clientSocket);
-    for (ssize_t i = 0; i < bytesRead; i++) {
-      std::cout << std::format("{:02X} ", buffer[i]);
+  m_metrics.add(Metrics::Counter::PACKETS_RECEIVED);
+  m_metrics.add(Metrics::Counter::BYTES_RECEIVED, bytesRead);
+
+  if (m_packetLogger) {
+    m_packetLogger->record(Shared::PacketLogger::Direction::INCOMING,
+                           clientSocket, readStart, bytesRead);
+  }
+  receive.size += bytesRead;
+
+  // Several inputs can arrive in one read; apply them in order so the
+  // sequence echoed back is the latest one.
+  size_t offset = 0;
+  while (offset < receive.size) {
+    const uint8_t type = receive.data[offset];
+    // Nothing after an unknown type can be framed, so waiting for more
+    // bytes would only hold back the inputs behind it.
+    if (!Shared::PacketCodec::isKnownPacketType(type)) {
+      Log::write(LogLevel::WARNING,
+                 "client {} disconnected: unknown packet type {}",
+                 clientSocket, static_cast<int>(type));
+      handleClientDisconnect(clientSocket);
+      return;
+    }
+    size_t packetSize = Shared::PacketCodec::getPacketSize(
+        receive.data.data() + offset, receive.size - offset);
+    if (packetSize == 0) {
+      break;
     }
-    std::cout << std::endl;
+    processPacket(clientSocket, receive.data.data() + offset, packetSize);
+    // A PLAYER_DISCONNECT closes the client and frees its buffer.
+    if (!m_receiveBuffers.contains(clientSocket)) {
+      return;
+    }
+    offset += packetSize;
   }
 
-  processPacket(clientSocket, buffer, bytesRead);
+  // Keep the start of a packet split across reads for the next one.
+  receive.size -= offset;
+  std::memmove(receive.data.data(), receive.data.data() + offset,
+               receive.size);
+  if (receive.size == receive.data.size()) {
+    Log::write(LogLevel::WARNING,
+               "client {} disconnected: packet larger than {} bytes",
+               clientSocket, receive.data.size());
+    handleClientDisconnect(clientSocket);
+  }
 }
 
 void Jetpack::Server::GameServer::processPacket(int clientSocket,
@@ -247,6 +457,9 @@ void Jetpack::Server::GameServer::processPacket(int clientSocket,
   case Shared::Protocol::PacketType::PLAYER_INPUT:
     handlePlayerInput(clientSocket, data, length);
     break;
+  case Shared::Protocol::PacketType::PLAYER_INPUT_EDGE:
+    handlePlayerInputEdge(clientSocket, data, length);
+    break;
   case Shared::Protocol::PacketType::PLAYER_DISCONNECT:
     handleClientDisconnect(clientSocket);
     break;
@@ -258,200 +471,303 @@ void Jetpack::Server::GameServer::processPacket(int clientSocket,
 void Jetpack::Server::GameServer::handlePlayerInput(int clientSocket,
                                                     const uint8_t *data,
                                                     size_t length) {
-  if (length < 2)
+  if (length < Shared::PacketCodec::PLAYER_INPUT_SIZE)
+    return;
+
+  bool isJetpacking = data[1] != 0;
+  uint16_t sequence = data[2] | (data[3] << 8);
+
+  auto it = m_clientMatches.find(clientSocket);
+  if (it != m_clientMatches.end()) {
+    it->second->setPlayerInput(clientSocket, isJetpacking, sequence);
+  }
+}
+
+void Jetpack::Server::GameServer::handlePlayerInputEdge(int clientSocket,
+                                                        const uint8_t *data,
+                                                        size_t length) {
+  if (length < Shared::PacketCodec::PLAYER_INPUT_EDGE_SIZE)
     return;
 
   bool isJetpacking = data[1] != 0;
+  uint16_t sequence = data[2] | (data[3] << 8);
+  uint32_t step = data[4] | (data[5] << 8) | (data[6] << 16) |
+                  (static_cast<uint32_t>(data[7]) << 24);
+
+  auto it = m_clientMatches.find(clientSocket);
+  if (it != m_clientMatches.end()) {
+    it->second->queuePlayerInput(clientSocket, isJetpacking, sequence, step);
+  }
+}
+
+void Jetpack::Server::GameServer::sendPacket(int clientSocket,
+                                             const uint8_t *data,
+                                             size_t length) {
+  ssize_t sent = send(clientSocket, data, length, 0);
+  if (sent > 0) {
+    m_metrics.add(Metrics::Counter::PACKETS_SENT);
+    m_metrics.add(Metrics::Counter::BYTES_SENT, sent);
+  }
 
-  auto it = m_players.find(clientSocket);
-  if (it != m_players.end() &&
-      it->second.getState() == Shared::Protocol::PlayerState::PLAYING) {
-    it->second.setJetpacking(isJetpacking);
+  if (m_packetLogger) {
+    m_packetLogger->record(Shared::PacketLogger::Direction::OUTGOING,
+                           clientSocket, data, length);
   }
 }
 
 void Jetpack::Server::GameServer::sendConnectResponse(int clientSocket,
-                                                      int playerId) {
+                                                      int playerId,
+                                                      size_t playerCount) {
   uint8_t buffer[3];
   buffer[0] =
       static_cast<uint8_t>(Shared::Protocol::PacketType::CONNECT_RESPONSE);
   buffer[1] = playerId;
-  buffer[2] = m_players.size();
+  buffer[2] = playerCount;
 
-  send(clientSocket, buffer, sizeof(buffer), 0);
-
-  if (m_debugMode) {
-    std::cout << std::format("Debug: Sent connection response to client {} "
-                             "(Player ID: {}) - Buffer: ",
-                             clientSocket, playerId);
-    for (size_t i = 0; i < sizeof(buffer); i++) {
-      std::cout << std::format("{:02X} ", buffer[i]);
-    }
-    std::cout << std::endl;
-  }
+  sendPacket(clientSocket, buffer, sizeof(buffer));
 }
 
-void Jetpack::Server::GameServer::sendMapData(int clientSocket) {
-  std::size_t bufferSize = 1 + 2 + 2 + m_map.width * m_map.height;
-  std::vector<uint8_t> buffer(bufferSize);
+void Jetpack::Server::GameServer::encodeMapData() {
+  const Shared::Protocol::GameMap &map = m_mapTemplate.map;
+  m_mapPacket.resize(1 + 2 + 2 + map.width * map.height);
 
-  buffer[0] = static_cast<uint8_t>(Shared::Protocol::PacketType::MAP_DATA);
+  m_mapPacket[0] = static_cast<uint8_t>(Shared::Protocol::PacketType::MAP_DATA);
 
-  buffer[1] = m_map.width & 0xFF;
-  buffer[2] = (m_map.width >> 8) & 0xFF;
-  buffer[3] = m_map.height & 0xFF;
-  buffer[4] = (m_map.height >> 8) & 0xFF;
+  m_mapPacket[1] = map.width & 0xFF;
+  m_mapPacket[2] = (map.width >> 8) & 0xFF;
+  m_mapPacket[3] = map.height & 0xFF;
+  m_mapPacket[4] = (map.height >> 8) & 0xFF;
 
-  for (int y = 0; y < m_map.height; y++) {
-    for (int x = 0; x < m_map.width; x++) {
-      buffer[5 + y * m_map.width + x] = static_cast<uint8_t>(m_map.tiles[y][x]);
+  for (int y = 0; y < map.height; y++) {
+    for (int x = 0; x < map.width; x++) {
+      m_mapPacket[5 + y * map.width + x] =
+          static_cast<uint8_t>(map.tiles[y][x]);
     }
   }
-
-  send(clientSocket, buffer.data(), buffer.size(), 0);
-
-  if (m_debugMode) {
-    std::cout << std::format(
-        "Debug: Sent map data to client {} (Socket: {}) - Buffer: ",
-        clientSocket, clientSocket);
-    for (size_t i = 0; i < buffer.size(); i++) {
-      std::cout << std::format("{:02X} ", buffer[i]);
-    }
-    std::cout << std::endl;
-  }
 }
 
-void Jetpack::Server::GameServer::checkGameStart() {
-  if (m_gameState != Shared::Protocol::GameState::WAITING_FOR_PLAYERS) {
-    return;
-  }
-
-  int readyPlayersCount = m_players.size();
+void Jetpack::Server::GameServer::sendMapData(int clientSocket) {
+  sendPacket(clientSocket, m_mapPacket.data(), m_mapPacket.size());
+}
 
-  if (readyPlayersCount >= MIN_PLAYERS) {
-    m_gameState = Shared::Protocol::GameState::IN_PROGRESS;
+void Jetpack::Server::GameServer::registerAdminCommands() {
+  m_adminServer->addCommand(
+      "matches", "matches", "list matches and their state",
+      [this](const AdminServer::Arguments &) { return adminListMatches(); });
+  m_adminServer->addCommand(
+      "players", "players [match]", "list players with RTT and send queue",
+      [this](const AdminServer::Arguments &arguments) {
+        return adminListPlayers(arguments);
+      });
+  m_adminServer->addCommand(
+      "map", "map <match> [x] [width]",
+      "dump the map with entities and players",
+      [this](const AdminServer::Arguments &arguments) {
+        return adminDumpMap(arguments);
+      });
+  m_adminServer->addCommand(
+      "end", "end <match>", "force a match to end",
+      [this](const AdminServer::Arguments &arguments) {
+        return adminEndMatch(arguments);
+      });
+  m_adminServer->addCommand(
+      "log", "log [error|warning|info|debug]", "show or set the log level",
+      [this](const AdminServer::Arguments &arguments) {
+        return adminSetLogLevel(arguments);
+      });
+  m_adminServer->addCommand(
+      "trace", "trace start <file>|stop", "start or stop Chrome tracing",
+      [this](const AdminServer::Arguments &arguments) {
+        return adminTrace(arguments);
+      });
+  m_adminServer->addCommand(
+      "tick", "tick", "show the tick budget and degradation state",
+      [this](const AdminServer::Arguments &) { return adminTickStatus(); });
+  m_adminServer->addCommand(
+      "packets", "packets on|off", "toggle the packet log (needs -d)",
+      [this](const AdminServer::Arguments &arguments) {
+        return adminPacketLog(arguments);
+      });
+}
 
-    for (auto &[_, player] : m_players) {
-      player.setState(Shared::Protocol::PlayerState::READY);
-      player.setPosition(1.0f, m_map.height - 2.0f);
+Jetpack::Server::Match *
+Jetpack::Server::GameServer::findMatch(const std::string &id) const {
+  for (Match *match : m_matchRunner.getMatches()) {
+    if (std::to_string(match->getId()) == id) {
+      return match;
     }
-
-    m_broadcaster.broadcastGameStart();
-    m_broadcaster.broadcastGameState();
   }
+  throw Jetpack::Shared::Exceptions::AdminException("no match " + id);
 }
 
-void Jetpack::Server::GameServer::updateGameState() {
-  if (m_gameState != Shared::Protocol::GameState::IN_PROGRESS) {
-    return;
+std::string Jetpack::Server::GameServer::adminListMatches() const {
+  std::string text = std::format("{:>6} {:<12} {:>7} {:>8}\n", "match",
+                                 "state", "players", "tick");
+  for (const Match *match : m_matchRunner.getMatches()) {
+    text += std::format("{:>6} {:<12} {:>7} {:>8}\n", match->getId(),
+                        toString(match->getGameState()),
+                        match->getPlayers().size(), match->getTick());
   }
+  return text;
+}
 
-  bool allReady = true;
-  bool anyPlaying = false;
-
-  for (const auto &[_, player] : m_players) {
-    if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
-      anyPlaying = true;
-    } else if (player.getState() == Shared::Protocol::PlayerState::READY) {
-    } else {
-      allReady = false;
+std::string Jetpack::Server::GameServer::adminListPlayers(
+    const AdminServer::Arguments &arguments) const {
+  const std::vector<Match *> &running = m_matchRunner.getMatches();
+  std::vector<const Match *> matches(running.begin(), running.end());
+  if (arguments.size() > 1) {
+    matches = {findMatch(arguments[1])};
+  }
+
+  std::string text =
+      std::format("{:>6} {:>3} {:>6} {:<12} {:>6} {:>8} {:>6} {:>8} {:>8}\n",
+                  "match", "id", "socket", "state", "score", "x", "y",
+                  "rtt_ms", "queued");
+  for (const Match *match : matches) {
+    for (const auto &[socket, player] : match->getPlayers()) {
+      tcp_info info{};
+      socklen_t infoLength = sizeof(info);
+      double rttMs = -1.0;
+      if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &infoLength) ==
+          0) {
+        rttMs = info.tcpi_rtt / 1000.0;
+      }
+      int queued = -1;
+      ioctl(socket, SIOCOUTQ, &queued);
+
+      const Shared::Protocol::Position position = player.getPosition();
+      text += std::format(
+          "{:>6} {:>3} {:>6} {:<12} {:>6} {:>8.2f} {:>6.2f} {:>8.2f} {:>8}\n",
+          match->getId(), player.getId(), socket, toString(player.getState()),
+          player.getScore(), position.x, position.y, rttMs, queued);
     }
   }
+  return text;
+}
 
-  if (allReady && !anyPlaying) {
-    for (auto &[_, player] : m_players) {
-      if (player.getState() == Shared::Protocol::PlayerState::READY) {
-        player.setState(Shared::Protocol::PlayerState::PLAYING);
+std::string Jetpack::Server::GameServer::adminDumpMap(
+    const AdminServer::Arguments &arguments) const {
+  if (arguments.size() < 2) {
+    throw Jetpack::Shared::Exceptions::AdminException(
+        "usage: map <match> [x] [width]");
+  }
+  const Match *match = findMatch(arguments[1]);
+  const Shared::Protocol::GameMap &map = match->getMap();
+
+  // Without an explicit column, start just behind the rearmost player.
+  int startX = map.width;
+  for (const auto &[_, player] : match->getPlayers()) {
+    startX = std::min(startX, static_cast<int>(player.getPosition().x) - 4);
+  }
+  startX = arguments.size() > 2 ? std::stoi(arguments[2]) : startX;
+  const int width = arguments.size() > 3 ? std::stoi(arguments[3])
+                                         : ADMIN_MAP_DEFAULT_WIDTH;
+  startX = std::clamp(startX, 0, std::max(0, map.width - 1));
+  const int endX = std::min(map.width, startX + std::max(width, 1));
+
+  std::vector<std::string> rows(map.height);
+  for (int y = 0; y < map.height; y++) {
+    for (int x = startX; x < endX; x++) {
+      switch (map.tiles[y][x]) {
+      case Shared::Protocol::TileType::COIN:
+        rows[y] += 'c';
+        break;
+      case Shared::Protocol::TileType::ELECTRICSQUARE:
+        rows[y] += 'e';
+        break;
+      default:
+        rows[y] += '_';
+        break;
       }
     }
-    m_broadcaster.broadcastGameState();
-    return;
   }
 
-  updatePlayers();
-  checkCollisions();
-  m_broadcaster.broadcastGameState();
-  checkGameEnd();
-}
-
-void Jetpack::Server::GameServer::updatePlayers() {
-  for (auto &[_, player] : m_players) {
-    if (player.getState() != Shared::Protocol::PlayerState::PLAYING) {
-      continue;
+  auto overlay = [&](float x, float y, char c) {
+    const int column = static_cast<int>(x) - startX;
+    const int row = static_cast<int>(y);
+    if (column >= 0 && column < endX - startX && row >= 0 &&
+        row < map.height) {
+      rows[row][column] = c;
     }
+  };
 
-    Physics::applyPhysics(player);
-    Physics::checkBounds(player, m_map);
-
-    if (player.getPosition().x >= m_map.width) {
-      player.setState(Shared::Protocol::PlayerState::FINISHED);
+  const EntityStore &entities = match->getEntities();
+  for (size_t id = 0; id < entities.size(); id++) {
+    if (entities.isAlive(id)) {
+      overlay(entities.getX(id), entities.getY(id),
+              toMapChar(entities.getType(id)));
     }
   }
-}
-
-void Jetpack::Server::GameServer::checkCollisions() {
-  for (auto &[_, player] : m_players) {
-    if (player.getState() != Shared::Protocol::PlayerState::PLAYING) {
-      continue;
-    }
-
-    int cell_x = static_cast<int>(player.getPosition().x);
-    int cell_y = static_cast<int>(player.getPosition().y);
-
-    if (cell_x >= 0 && cell_x < m_map.width && cell_y >= 0 &&
-        cell_y < m_map.height) {
-      Shared::Protocol::TileType tile = m_map.tiles[cell_y][cell_x];
-
-      if (tile == Shared::Protocol::TileType::COIN) {
-        player.setScore(player.getScore() + 1);
-        m_map.tiles[cell_y][cell_x] = Shared::Protocol::TileType::EMPTY;
-
-        m_broadcaster.broadcastCoinCollected(player.getId(), cell_x, cell_y);
-
-      } else if (tile == Shared::Protocol::TileType::ELECTRICSQUARE) {
-        player.setState(Shared::Protocol::PlayerState::DEAD);
+  for (const auto &[_, player] : match->getPlayers()) {
+    overlay(player.getPosition().x, player.getPosition().y,
+            static_cast<char>('0' + player.getId() % 10));
+  }
 
-        m_broadcaster.broadcastPlayerDeath(player.getId());
-      }
-    }
+  std::string text = std::format("match {} columns {}-{} tick {}\n",
+                                 match->getId(), startX, endX - 1,
+                                 match->getTick());
+  for (const std::string &row : rows) {
+    text += row + "\n";
   }
+  return text;
 }
 
-void Jetpack::Server::GameServer::checkGameEnd() {
-  bool allFinished = true;
-  bool anyDead = false;
-  int activePlayersCount = 0;
+std::string Jetpack::Server::GameServer::adminEndMatch(
+    const AdminServer::Arguments &arguments) {
+  if (arguments.size() < 2) {
+    throw Jetpack::Shared::Exceptions::AdminException(
+        "usage: end <match>");
+  }
+  Match *match = findMatch(arguments[1]);
+  // The match is closed by the next updateMatches() like any finished one.
+  match->forceEnd();
+  return std::format("match {} ended\n", match->getId());
+}
 
-  for (const auto &[_, player] : m_players) {
-    if (player.getState() == Shared::Protocol::PlayerState::PLAYING) {
-      allFinished = false;
-      activePlayersCount++;
-    } else if (player.getState() == Shared::Protocol::PlayerState::FINISHED) {
-      activePlayersCount++;
-    } else if (player.getState() == Shared::Protocol::PlayerState::DEAD) {
-      anyDead = true;
+std::string Jetpack::Server::GameServer::adminSetLogLevel(
+    const AdminServer::Arguments &arguments) {
+  if (arguments.size() > 1) {
+    LogLevel level;
+    if (!Log::parse(arguments[1], level)) {
+      throw Jetpack::Shared::Exceptions::AdminException(
+          "unknown log level " + arguments[1]);
     }
+    Log::setLevel(level);
   }
+  return std::format("log level {}\n", Log::toString(Log::getLevel()));
+}
 
-  if ((allFinished && activePlayersCount > 0) || anyDead ||
-      (activePlayersCount < MIN_PLAYERS && m_players.size() >= MIN_PLAYERS)) {
-    m_gameState = Shared::Protocol::GameState::GAME_OVER;
-
-    int winnerId = -1;
-    int highestScore = -1;
-
-    for (const auto &[_, player] : m_players) {
-      if (anyDead && player.getState() != Shared::Protocol::PlayerState::DEAD) {
-        winnerId = player.getId();
-        break;
-      }
+std::string Jetpack::Server::GameServer::adminTrace(
+    const AdminServer::Arguments &arguments) {
+  if (arguments.size() == 3 && arguments[1] == "start") {
+    Shared::Trace::start(arguments[2], "jetpack_server");
+    return "tracing to " + arguments[2] + "\n";
+  }
+  if (arguments.size() == 2 && arguments[1] == "stop") {
+    Shared::Trace::stop();
+    return "tracing stopped\n";
+  }
+  throw Jetpack::Shared::Exceptions::AdminException(
+      "usage: trace start <file>|stop");
+}
 
-      if (player.getScore() > highestScore) {
-        highestScore = player.getScore();
-        winnerId = player.getId();
-      }
+std::string Jetpack::Server::GameServer::adminPacketLog(
+    const AdminServer::Arguments &arguments) {
+  if (!m_packetLogger) {
+    throw Jetpack::Shared::Exceptions::AdminException(
+        "packet logging needs the server to run with -d");
+  }
+  if (arguments.size() > 1) {
+    if (arguments[1] != "on" && arguments[1] != "off") {
+      throw Jetpack::Shared::Exceptions::AdminException(
+          "usage: packets on|off");
     }
-
-    m_broadcaster.broadcastGameOver(winnerId);
+    m_packetLogger->setEnabled(arguments[1] == "on");
   }
+  return std::format("packet log {}\n",
+                     m_packetLogger->isEnabled() ? "on" : "off");
+}
+
+std::string Jetpack::Server::GameServer::adminTickStatus() const {
+  return m_watchdog.describe();
 }
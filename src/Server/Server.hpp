@@ -1,66 +1,113 @@
 #pragma once
 
+#include "../Shared/PacketLogger.hpp"
 #include "../Shared/Protocol.hpp"
-#include "Broadcaster.hpp"
+#include "AdminServer.hpp"
+#include "Match.hpp"
+#include "MatchRunner.hpp"
+#include "MatchRecording.hpp"
+#include "Metrics.hpp"
+#include "MetricsServer.hpp"
+#include "ServerConfig.hpp"
+#include "ThreadPool.hpp"
+#include "TickWatchdog.hpp"
+#include <array>
+#include <chrono>
 #include <filesystem>
+#include <memory>
 #include <poll.h>
 #include <string>
 #include <unistd.h>
 #include <unordered_map>
+#include <vector>
 
 namespace Jetpack::Server {
 class GameServer {
 public:
-  GameServer(int port, const std::string &mapFile, bool debugMode = false);
+  explicit GameServer(const ServerConfig &config);
   ~GameServer();
 
   void start();
 
 private:
-  static constexpr int MAX_CLIENTS = 2;
-  static constexpr int MIN_PLAYERS = 2;
-  static constexpr int GAME_TICK_MS = 16;
+  static constexpr auto TICK_PERIOD = Match::TICK_PERIOD;
+  // Past this many missed ticks the loop stops catching up and drops them.
+  static constexpr int MAX_CATCH_UP_TICKS = 5;
   static constexpr int BUFFER_SIZE = 1024;
+  static constexpr auto SEND_QUEUE_SAMPLE_INTERVAL = std::chrono::seconds(1);
+  static constexpr int ADMIN_MAP_DEFAULT_WIDTH = 80;
+
+  // Bytes read from a client that do not yet make up a whole packet; they
+  // are completed by the next reads.
+  struct ReceiveBuffer {
+    std::array<uint8_t, BUFFER_SIZE> data;
+    size_t size = 0;
+  };
 
   bool loadMap();
   void initializeSocket();
 
   void handleSocketEvents();
   void acceptNewClient();
+  void addClient(int clientSocket);
   void handleClientData(int clientSocket);
   void handleClientDisconnect(int clientSocket);
+  void removePollfd(int socket);
 
-  void sendConnectResponse(int clientSocket, int playerId);
+  void sendPacket(int clientSocket, const uint8_t *data, size_t length);
+  void sendConnectResponse(int clientSocket, int playerId, size_t playerCount);
+  void encodeMapData();
   void sendMapData(int clientSocket);
 
-  void checkGameStart();
-
-  void updateGameState();
-  void updatePlayers();
-  void checkCollisions();
-  void checkGameEnd();
+  void runTick();
+  void updateMatches();
+  void sampleSendQueues();
+  void closeMatch(Match *match);
+  void saveRecording(Match *match);
+
+  void registerAdminCommands();
+  std::string adminListMatches() const;
+  std::string adminListPlayers(const AdminServer::Arguments &arguments) const;
+  std::string adminDumpMap(const AdminServer::Arguments &arguments) const;
+  std::string adminEndMatch(const AdminServer::Arguments &arguments);
+  std::string adminSetLogLevel(const AdminServer::Arguments &arguments);
+  std::string adminTrace(const AdminServer::Arguments &arguments);
+  std::string adminPacketLog(const AdminServer::Arguments &arguments);
+  std::string adminTickStatus() const;
+  Match *findMatch(const std::string &id) const;
 
   void processPacket(int clientSocket, const uint8_t *data, size_t length);
   void handlePlayerInput(int clientSocket, const uint8_t *data, size_t length);
+  void handlePlayerInputEdge(int clientSocket, const uint8_t *data,
+                             size_t length);
 
 private:
+  ServerConfig m_config;
   int m_port;
   std::filesystem::path m_mapFile;
-  bool m_debugMode;
 
-  Shared::Protocol::GameMap m_map;
+  MapTemplate m_mapTemplate;
+  std::vector<uint8_t> m_mapPacket;
 
   int m_serverSocket = -1;
 
   std::vector<pollfd> m_pollfds;
 
-  std::unordered_map<int, Shared::Protocol::Player> m_players;
-
-  Broadcaster m_broadcaster;
-
-  Shared::Protocol::GameState m_gameState =
-      Shared::Protocol::GameState::WAITING_FOR_PLAYERS;
-
+  std::unique_ptr<Shared::PacketLogger> m_packetLogger;
+  std::unique_ptr<ThreadPool> m_threadPool;
+  Metrics m_metrics;
+  MatchRunner m_matchRunner;
+  TickWatchdog m_watchdog;
+  std::unique_ptr<MetricsServer> m_metricsServer;
+  std::unique_ptr<AdminServer> m_adminServer;
+
+  Match *m_waitingMatch = nullptr;
+  std::unordered_map<int, Match *> m_clientMatches;
+  std::unordered_map<int, ReceiveBuffer> m_receiveBuffers;
+  std::unordered_map<Match *, std::unique_ptr<MatchRecording>> m_recordings;
+
+  std::chrono::steady_clock::time_point m_lastSendQueueSample =
+      std::chrono::steady_clock::now();
   bool m_running = true;
 };
 } // namespace Jetpack::Server
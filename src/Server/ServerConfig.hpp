@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Jetpack::Server {
+enum class DegradationStep { SNAPSHOT_RATE, COSMETIC_EVENTS, MATCH_ADMISSION };
+
+struct ServerConfig {
+  int port = 8080;
+  std::string mapFile;
+  bool debugMode = false;
+  std::string packetLogFile = "jetpack_server.pktlog";
+  int metricsPort = 0;
+  std::string adminSocketPath;
+  std::string recordDirectory;
+
+  int playersPerMatch = 2;
+  size_t simulationThreads = 1;
+
+  int tickBudgetMs = 16;
+  // Applied in order while ticks keep overrunning their budget.
+  std::vector<DegradationStep> degradationSteps = {
+      DegradationStep::SNAPSHOT_RATE, DegradationStep::COSMETIC_EVENTS,
+      DegradationStep::MATCH_ADMISSION};
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,95 @@
+#include "SpatialHash.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+template <typename Visitor>
+void Jetpack::Server::SpatialHash::forEachCell(const EntityStore &entities,
+                                               size_t id,
+                                               Visitor &&visitor) const {
+  if (!entities.isAlive(id)) {
+    return;
+  }
+
+  Shared::Protocol::Position extent =
+      Shared::Protocol::getEntityHalfExtent(entities.getType(id));
+  int minX = toCell(entities.getX(id) - extent.x);
+  int maxX = toCell(entities.getX(id) + extent.x);
+  int minY = toCell(entities.getY(id) - extent.y);
+  int maxY = toCell(entities.getY(id) + extent.y);
+
+  for (int cellY = minY; cellY <= maxY; cellY++) {
+    for (int cellX = minX; cellX <= maxX; cellX++) {
+      visitor(getBucket(cellX, cellY));
+    }
+  }
+}
+
+void Jetpack::Server::SpatialHash::reserve(const EntityStore &entities) {
+  m_reservedEntities = entities.size();
+  m_bucketStart.reserve(
+      std::bit_ceil(std::max(MIN_BUCKETS, entities.size() * 2)) + 1);
+
+  size_t cells = 0;
+  for (size_t id = 0; id < entities.size(); id++) {
+    Shared::Protocol::Position extent =
+        Shared::Protocol::getEntityHalfExtent(entities.getType(id));
+    cells += static_cast<size_t>(std::ceil(2 * extent.x / m_cellSize) + 1) *
+             static_cast<size_t>(std::ceil(2 * extent.y / m_cellSize) + 1);
+  }
+  m_entries.reserve(cells);
+}
+
+void Jetpack::Server::SpatialHash::rebuild(const EntityStore &entities,
+                                          std::span<const uint32_t> ids) {
+  if (m_reservedEntities != entities.size()) {
+    reserve(entities);
+  }
+  size_t bucketCount = std::bit_ceil(std::max(MIN_BUCKETS, ids.size() * 2));
+  m_bucketMask = bucketCount - 1;
+
+  m_bucketStart.assign(bucketCount + 1, 0);
+  for (uint32_t id : ids) {
+    forEachCell(entities, id,
+                [this](size_t bucket) { m_bucketStart[bucket + 1]++; });
+  }
+
+  for (size_t i = 1; i <= bucketCount; i++) {
+    m_bucketStart[i] += m_bucketStart[i - 1];
+  }
+
+  m_entries.resize(m_bucketStart[bucketCount]);
+  for (uint32_t id : ids) {
+    forEachCell(entities, id, [this, id](size_t bucket) {
+      m_entries[m_bucketStart[bucket]++] = id;
+    });
+  }
+
+  // The fill pass advanced every start to the next bucket's start.
+  for (size_t i = bucketCount; i > 0; i--) {
+    m_bucketStart[i] = m_bucketStart[i - 1];
+  }
+  m_bucketStart[0] = 0;
+}
+
+std::span<const uint32_t>
+Jetpack::Server::SpatialHash::getCandidates(float x, float y) const {
+  if (m_bucketStart.empty()) {
+    return {};
+  }
+
+  size_t bucket = getBucket(toCell(x), toCell(y));
+  return std::span<const uint32_t>(m_entries.data() + m_bucketStart[bucket],
+                                   m_bucketStart[bucket + 1] -
+                                       m_bucketStart[bucket]);
+}
+
+int Jetpack::Server::SpatialHash::toCell(float coordinate) const {
+  return static_cast<int>(std::floor(coordinate / m_cellSize));
+}
+
+size_t Jetpack::Server::SpatialHash::getBucket(int cellX, int cellY) const {
+  uint32_t hash = static_cast<uint32_t>(cellX) * 73856093u ^
+                  static_cast<uint32_t>(cellY) * 19349663u;
+  return hash & m_bucketMask;
+}
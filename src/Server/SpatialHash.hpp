@@ -0,0 +1,39 @@
+#pragma once
+
+#include "EntityStore.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace Jetpack::Server {
+class SpatialHash {
+public:
+  explicit SpatialHash(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+      float cellSize = 4.0f)
+      : m_cellSize(cellSize), m_bucketStart(resource), m_entries(resource) {}
+
+  // Hashes only the given entities, typically those near the players.
+  void rebuild(const EntityStore &entities, std::span<const uint32_t> ids);
+  std::span<const uint32_t> getCandidates(float x, float y) const;
+
+private:
+  static constexpr size_t MIN_BUCKETS = 64;
+
+  // Room for every entity at once, so rebuilds never allocate.
+  void reserve(const EntityStore &entities);
+  int toCell(float coordinate) const;
+  size_t getBucket(int cellX, int cellY) const;
+
+  template <typename Visitor>
+  void forEachCell(const EntityStore &entities, size_t id,
+                   Visitor &&visitor) const;
+
+  float m_cellSize;
+  size_t m_bucketMask = 0;
+  size_t m_reservedEntities = 0;
+  std::pmr::vector<uint32_t> m_bucketStart;
+  std::pmr::vector<uint32_t> m_entries;
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,88 @@
+#include "ThreadPool.hpp"
+#include "AllocationCounter.hpp"
+#include "../Shared/Trace.hpp"
+
+Jetpack::Server::ThreadPool::ThreadPool(size_t threadCount) {
+  for (size_t i = 1; i < threadCount; i++) {
+    m_workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+Jetpack::Server::ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_wakeCondition.notify_all();
+
+  for (auto &worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void Jetpack::Server::ThreadPool::run(size_t taskCount, void *context,
+                                      TaskFunction function) {
+  if (taskCount == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_context = context;
+    m_function = function;
+    m_taskCount = taskCount;
+    m_nextTask.store(0, std::memory_order_relaxed);
+    m_busyWorkers = m_workers.size();
+    m_generation++;
+  }
+  m_wakeCondition.notify_all();
+
+  executeTasks();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_doneCondition.wait(lock, [this] { return m_busyWorkers == 0; });
+}
+
+void Jetpack::Server::ThreadPool::workerLoop() {
+  Shared::Trace::setThreadName("pool worker");
+  uint64_t seenGeneration = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wakeCondition.wait(lock, [this, seenGeneration] {
+        return m_stopping || m_generation != seenGeneration;
+      });
+      if (m_stopping) {
+        return;
+      }
+      seenGeneration = m_generation;
+    }
+
+    const uint64_t allocationsBefore = AllocationCounter::getAllocationCount();
+    executeTasks();
+    const uint64_t allocations =
+        AllocationCounter::getAllocationCount() - allocationsBefore;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_workerAllocations += allocations;
+    if (--m_busyWorkers == 0) {
+      m_doneCondition.notify_one();
+    }
+  }
+}
+
+void Jetpack::Server::ThreadPool::executeTasks() {
+  size_t index;
+  while ((index = m_nextTask.fetch_add(1, std::memory_order_relaxed)) <
+         m_taskCount) {
+    m_function(m_context, index);
+  }
+}
+
+uint64_t Jetpack::Server::ThreadPool::getWorkerAllocationCount() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_workerAllocations;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Jetpack::Server {
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t threadCount);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t getThreadCount() const { return m_workers.size() + 1; }
+
+  // Heap allocations the workers made while running tasks. Tasks run by the
+  // calling thread count towards that thread instead.
+  uint64_t getWorkerAllocationCount();
+
+  // Runs task(0) .. task(taskCount - 1) across the pool and the calling
+  // thread, returning once every task has completed.
+  template <typename Task> void parallelFor(size_t taskCount, Task &&task) {
+    using TaskType = std::remove_reference_t<Task>;
+    run(taskCount, std::addressof(task), [](void *context, size_t index) {
+      (*static_cast<TaskType *>(context))(index);
+    });
+  }
+
+private:
+  using TaskFunction = void (*)(void *, size_t);
+
+  void run(size_t taskCount, void *context, TaskFunction function);
+  void workerLoop();
+  void executeTasks();
+
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeCondition;
+  std::condition_variable m_doneCondition;
+
+  void *m_context = nullptr;
+  TaskFunction m_function = nullptr;
+  size_t m_taskCount = 0;
+  std::atomic<size_t> m_nextTask{0};
+  size_t m_busyWorkers = 0;
+  uint64_t m_workerAllocations = 0;
+  uint64_t m_generation = 0;
+  bool m_stopping = false;
+};
+} // namespace Jetpack::Server
@@ -0,0 +1,166 @@
+#include "TickWatchdog.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <format>
+
+namespace {
+double toMilliseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+} // namespace
+
+Jetpack::Server::TickWatchdog::TickWatchdog(
+    std::chrono::nanoseconds budget, std::vector<DegradationStep> steps,
+    Metrics &metrics)
+    : m_budget(budget), m_steps(std::move(steps)), m_metrics(metrics) {
+  for (size_t i = 0; i < PHASES.size(); i++) {
+    m_phaseTotals[i] = m_metrics.getTotal(PHASES[i]);
+  }
+}
+
+void Jetpack::Server::TickWatchdog::recordTick(
+    std::chrono::nanoseconds work) {
+  PhaseTimes phases;
+  for (size_t i = 0; i < PHASES.size(); i++) {
+    const std::chrono::nanoseconds total = m_metrics.getTotal(PHASES[i]);
+    phases[i] = total - m_phaseTotals[i];
+    m_phaseTotals[i] = total;
+  }
+
+  // Socket events are handled between ticks but still eat into the budget.
+  const std::chrono::nanoseconds busy = work + phases[0];
+  m_windowBusy += busy;
+  m_windowTicks++;
+
+  if (busy > m_budget) {
+    m_windowOverruns++;
+    m_totalOverruns++;
+    m_metrics.add(Metrics::Counter::TICK_OVERRUNS);
+    if (busy > m_worstBusy) {
+      m_worstBusy = busy;
+      m_worstPhases = phases;
+    }
+  }
+
+  if (m_windowTicks == WINDOW_TICKS) {
+    evaluateWindow();
+  }
+}
+
+void Jetpack::Server::TickWatchdog::evaluateWindow() {
+  if (m_windowOverruns > 0) {
+    std::string breakdown;
+    std::chrono::nanoseconds accounted{0};
+    for (size_t i = 0; i < PHASES.size(); i++) {
+      breakdown += std::format("{} {:.2f}, ", PHASE_NAMES[i],
+                               toMilliseconds(m_worstPhases[i]));
+      accounted += m_worstPhases[i];
+    }
+    breakdown += std::format(
+        "other {:.2f}",
+        toMilliseconds(std::max(m_worstBusy - accounted,
+                                std::chrono::nanoseconds(0))));
+
+    Log::write(LogLevel::WARNING,
+               "{} of {} ticks over the {:.2f} ms budget, worst {:.2f} ms "
+               "({})",
+               m_windowOverruns, m_windowTicks, toMilliseconds(m_budget),
+               toMilliseconds(m_worstBusy), breakdown);
+  }
+
+  const bool overloaded =
+      m_windowOverruns * 100 >= m_windowTicks * OVERLOAD_PERCENT;
+  const bool calm = m_windowOverruns == 0 &&
+                    m_windowBusy * 100 <=
+                        m_budget * m_windowTicks * RECOVERY_LOAD_PERCENT;
+
+  if (overloaded) {
+    m_calmWindows = 0;
+    if (m_level < m_steps.size()) {
+      Log::write(LogLevel::WARNING, "tick overload: applying {}",
+                 toString(m_steps[m_level]));
+      setLevel(m_level + 1);
+    }
+  } else if (calm && m_level > 0) {
+    // Step back down slowly so that shedding load does not immediately
+    // re-trigger the overload it relieved.
+    if (++m_calmWindows >= RECOVERY_WINDOWS) {
+      m_calmWindows = 0;
+      Log::write(LogLevel::WARNING, "tick load recovered: lifting {}",
+                 toString(m_steps[m_level - 1]));
+      setLevel(m_level - 1);
+    }
+  } else {
+    m_calmWindows = 0;
+  }
+
+  m_windowTicks = 0;
+  m_windowOverruns = 0;
+  m_windowBusy = std::chrono::nanoseconds(0);
+  m_worstBusy = std::chrono::nanoseconds(0);
+}
+
+void Jetpack::Server::TickWatchdog::setLevel(size_t level) {
+  m_level = level;
+  m_matchDegradation.snapshotInterval =
+      isApplied(DegradationStep::SNAPSHOT_RATE) ? DEGRADED_SNAPSHOT_INTERVAL
+                                                : 1;
+  m_matchDegradation.ownerOnlyEvents =
+      isApplied(DegradationStep::COSMETIC_EVENTS);
+  m_metrics.set(Metrics::Gauge::DEGRADATION_LEVEL, m_level);
+}
+
+bool Jetpack::Server::TickWatchdog::isApplied(DegradationStep step) const {
+  return std::find(m_steps.begin(), m_steps.begin() + m_level, step) !=
+         m_steps.begin() + m_level;
+}
+
+std::string Jetpack::Server::TickWatchdog::describe() const {
+  std::string applied;
+  for (size_t i = 0; i < m_level; i++) {
+    applied += std::string(applied.empty() ? "" : ",") + toString(m_steps[i]);
+  }
+  return std::format("budget {:.2f} ms, {} overruns, level {}/{} ({})\n",
+                     toMilliseconds(m_budget), m_totalOverruns, m_level,
+                     m_steps.size(), applied.empty() ? "none" : applied);
+}
+
+const char *Jetpack::Server::TickWatchdog::toString(DegradationStep step) {
+  switch (step) {
+  case DegradationStep::SNAPSHOT_RATE:
+    return "snapshots";
+  case DegradationStep::COSMETIC_EVENTS:
+    return "cosmetic";
+  case DegradationStep::MATCH_ADMISSION:
+    return "admission";
+  }
+  return "unknown";
+}
+
+bool Jetpack::Server::TickWatchdog::parseSteps(
+    std::string_view list, std::vector<DegradationStep> &steps) {
+  steps.clear();
+  if (list == "none") {
+    return true;
+  }
+
+  while (!list.empty()) {
+    const size_t comma = list.find(',');
+    const std::string_view name = list.substr(0, comma);
+    bool found = false;
+    for (DegradationStep step :
+         {DegradationStep::SNAPSHOT_RATE, DegradationStep::COSMETIC_EVENTS,
+          DegradationStep::MATCH_ADMISSION}) {
+      if (name == toString(step)) {
+        steps.push_back(step);
+        found = true;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+    list = comma == std::string_view::npos ? std::string_view()
+                                           : list.substr(comma + 1);
+  }
+  return !steps.empty();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Match.hpp"
+#include "Metrics.hpp"
+#include "ServerConfig.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Jetpack::Server {
+// Compares the time the game loop spends on each tick against its budget.
+// Overruns are counted and summarised once per window with the phase
+// breakdown of the worst one; when they persist, the configured degradation
+// steps are applied one at a time and lifted again once load drops.
+class TickWatchdog {
+public:
+  TickWatchdog(std::chrono::nanoseconds budget,
+               std::vector<DegradationStep> steps, Metrics &metrics);
+
+  // work is the time spent running the tick itself; socket handling since
+  // the previous tick is added from the network phase metrics.
+  void recordTick(std::chrono::nanoseconds work);
+
+  size_t getLevel() const { return m_level; }
+  bool isApplied(DegradationStep step) const;
+  bool isAcceptingMatches() const {
+    return !isApplied(DegradationStep::MATCH_ADMISSION);
+  }
+  const MatchDegradation &getMatchDegradation() const {
+    return m_matchDegradation;
+  }
+
+  std::string describe() const;
+
+  static const char *toString(DegradationStep step);
+  static bool parseSteps(std::string_view list,
+                         std::vector<DegradationStep> &steps);
+
+private:
+  static constexpr size_t WINDOW_TICKS = 60;
+  static constexpr size_t OVERLOAD_PERCENT = 25;
+  static constexpr size_t RECOVERY_LOAD_PERCENT = 50;
+  static constexpr size_t RECOVERY_WINDOWS = 3;
+  static constexpr uint32_t DEGRADED_SNAPSHOT_INTERVAL = 2;
+
+  static constexpr std::array<Metrics::Histogram, 5> PHASES = {
+      Metrics::Histogram::NETWORK_PHASE, Metrics::Histogram::ENTITIES_PHASE,
+      Metrics::Histogram::PLAYERS_PHASE, Metrics::Histogram::COLLISIONS_PHASE,
+      Metrics::Histogram::BROADCAST_PHASE};
+  static constexpr std::array<std::string_view, PHASES.size()> PHASE_NAMES = {
+      "network", "entities", "players", "collisions", "broadcast"};
+
+  using PhaseTimes = std::array<std::chrono::nanoseconds, PHASES.size()>;
+
+  void evaluateWindow();
+  void setLevel(size_t level);
+
+  std::chrono::nanoseconds m_budget;
+  std::vector<DegradationStep> m_steps;
+  Metrics &m_metrics;
+
+  size_t m_level = 0;
+  MatchDegradation m_matchDegradation;
+
+  PhaseTimes m_phaseTotals{};
+  size_t m_windowTicks = 0;
+  size_t m_windowOverruns = 0;
+  std::chrono::nanoseconds m_windowBusy{0};
+  std::chrono::nanoseconds m_worstBusy{0};
+  PhaseTimes m_worstPhases{};
+  size_t m_calmWindows = 0;
+  uint64_t m_totalOverruns = 0;
+};
+} // namespace Jetpack::Server
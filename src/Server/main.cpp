@@ -1,49 +1,122 @@
+#include "../Shared/Trace.hpp"
 #include "Server.hpp"
+#include <csignal>
 #include <iostream>
+#include <sys/resource.h>
 
 static void usage(char *program_name) {
-  std::cerr << "Usage: " << program_name << "-p <port> -m <map> [-d]"
+  std::cerr << "Usage: " << program_name
+            << " -p <port> -m <map> [-d] [-l <packet log>] [-n <players>]"
+               " [-t <threads>] [-M <metrics port>] [-A <admin socket>]"
+               " [-B <tick budget ms>] [--degrade <steps>|none]"
+               " [-R <recording dir>]"
+               " [--trace <file>]"
             << std::endl;
 }
 
+// Each client holds a descriptor, so lift the soft limit as far as allowed.
+static void raiseDescriptorLimit() {
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
 int main(int argc, char *argv[]) {
-  int port = 8080;
-  std::string map_file;
-  bool debug_mode = false;
+  Jetpack::Server::ServerConfig config;
+  std::string traceFile;
 
   for (int i = 1; i < argc; i++) {
     std::string arg = argv[i];
 
     if (arg == "-p" && i + 1 < argc) {
-      port = std::stoi(argv[++i]);
+      config.port = std::stoi(argv[++i]);
     } else if (arg == "-m" && i + 1 < argc) {
-      map_file = argv[++i];
+      config.mapFile = argv[++i];
     } else if (arg == "-d") {
-      debug_mode = true;
+      config.debugMode = true;
+    } else if (arg == "-l" && i + 1 < argc) {
+      config.packetLogFile = argv[++i];
+    } else if (arg == "-n" && i + 1 < argc) {
+      config.playersPerMatch = std::stoi(argv[++i]);
+    } else if (arg == "-t" && i + 1 < argc) {
+      config.simulationThreads = std::stoul(argv[++i]);
+    } else if (arg == "-M" && i + 1 < argc) {
+      config.metricsPort = std::stoi(argv[++i]);
+    } else if (arg == "-A" && i + 1 < argc) {
+      config.adminSocketPath = argv[++i];
+    } else if (arg == "-R" && i + 1 < argc) {
+      config.recordDirectory = argv[++i];
+    } else if (arg == "-B" && i + 1 < argc) {
+      config.tickBudgetMs = std::stoi(argv[++i]);
+    } else if (arg == "--degrade" && i + 1 < argc) {
+      if (!Jetpack::Server::TickWatchdog::parseSteps(
+              argv[++i], config.degradationSteps)) {
+        std::cerr << "Error: Degradation steps are a comma-separated list of"
+                     " snapshots, cosmetic and admission"
+                  << std::endl;
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--trace" && i + 1 < argc) {
+      traceFile = argv[++i];
     } else {
       usage(argv[0]);
       return 1;
     }
   }
 
-  if (map_file.empty()) {
+  if (config.mapFile.empty()) {
     std::cerr << "Error: Map file is required" << std::endl;
     usage(argv[0]);
     return 1;
   }
-  if (port <= 0 || port > 65535) {
+  if (config.port <= 0 || config.port > 65535) {
     std::cerr << "Error: Invalid port number" << std::endl;
     usage(argv[0]);
     return 1;
   }
+  if (config.playersPerMatch < 2 || config.playersPerMatch > 255) {
+    std::cerr << "Error: Players per match must be between 2 and 255"
+              << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+  if (config.metricsPort < 0 || config.metricsPort > 65535) {
+    std::cerr << "Error: Invalid metrics port number" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+  if (config.tickBudgetMs <= 0) {
+    std::cerr << "Error: Invalid tick budget" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+  if (config.simulationThreads == 0) {
+    std::cerr << "Error: Invalid thread count" << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  // A client closing mid-send must surface as EPIPE, not kill the server.
+  std::signal(SIGPIPE, SIG_IGN);
+  raiseDescriptorLimit();
 
   try {
-    Jetpack::Server::GameServer server(port, map_file, debug_mode);
+    if (!traceFile.empty()) {
+      Jetpack::Shared::Trace::start(traceFile, "jetpack_server");
+    }
+    Jetpack::Server::GameServer server(config);
     server.start();
   } catch (const std::exception &e) {
     std::cerr << "Error: " << e.what() << std::endl;
+    Jetpack::Shared::Trace::stop();
     return 1;
   }
 
+  Jetpack::Shared::Trace::stop();
+
   return 0;
 }
@@ -22,6 +22,42 @@ public:
       : Exception("Socket error: " + message) {}
 };
 
+class PacketLoggerException : public Exception {
+public:
+  explicit PacketLoggerException(const std::string &message)
+      : Exception("Packet logger error: " + message) {}
+};
+
+class TraceException : public Exception {
+public:
+  explicit TraceException(const std::string &message)
+      : Exception("Trace error: " + message) {}
+};
+
+class NetSimException : public Exception {
+public:
+  explicit NetSimException(const std::string &message)
+      : Exception("Network simulator error: " + message) {}
+};
+
+class AdminException : public Exception {
+public:
+  explicit AdminException(const std::string &message)
+      : Exception("Admin command error: " + message) {}
+};
+
+class RecordingException : public Exception {
+public:
+  explicit RecordingException(const std::string &message)
+      : Exception("Match recording error: " + message) {}
+};
+
+class BatchException : public Exception {
+public:
+  explicit BatchException(const std::string &message)
+      : Exception("Batch simulation error: " + message) {}
+};
+
 class GameServerException : public Exception {
 public:
   explicit GameServerException(const std::string &message)
@@ -0,0 +1,36 @@
+#include "LatencyStats.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+double Jetpack::Shared::LatencyStats::percentile(double fraction) const {
+  if (m_samples.empty()) {
+    return 0.0;
+  }
+
+  const size_t index = std::min(
+      m_samples.size() - 1, static_cast<size_t>(fraction * m_samples.size()));
+  std::nth_element(m_samples.begin(), m_samples.begin() + index,
+                   m_samples.end());
+  return m_samples[index];
+}
+
+double Jetpack::Shared::LatencyStats::max() const {
+  if (m_samples.empty()) {
+    return 0.0;
+  }
+  return *std::max_element(m_samples.begin(), m_samples.end());
+}
+
+std::string Jetpack::Shared::LatencyStats::summary(
+    const std::vector<double> &fractions) const {
+  std::ostringstream out;
+
+  for (double fraction : fractions) {
+    out << std::defaultfloat << std::setprecision(4) << "p" << fraction * 100.0
+        << " " << std::fixed << std::setprecision(2) << percentile(fraction)
+        << " ms  ";
+  }
+  out << "max " << max() << " ms";
+  return out.str();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Jetpack::Shared {
+// Collects latency samples in milliseconds and reports their percentiles.
+class LatencyStats {
+public:
+  void add(double milliseconds) { m_samples.push_back(milliseconds); }
+  void clear() { m_samples.clear(); }
+
+  size_t count() const { return m_samples.size(); }
+  bool empty() const { return m_samples.empty(); }
+
+  double percentile(double fraction) const;
+  double max() const;
+
+  // "p50 1.23 ms  p90 ...  max ..." for the given percentiles.
+  std::string summary(const std::vector<double> &fractions = {
+                          0.50, 0.90, 0.99, 0.999}) const;
+
+private:
+  // percentile() partially reorders the samples, which changes no result.
+  mutable std::vector<double> m_samples;
+};
+} // namespace Jetpack::Shared
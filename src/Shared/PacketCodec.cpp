@@ -0,0 +1,143 @@
+#include "PacketCodec.hpp"
+
+bool Jetpack::Shared::PacketCodec::isKnownPacketType(uint8_t type) {
+  switch (static_cast<Protocol::PacketType>(type)) {
+  case Protocol::PacketType::CONNECT_REQUEST:
+  case Protocol::PacketType::CONNECT_RESPONSE:
+  case Protocol::PacketType::MAP_DATA:
+  case Protocol::PacketType::GAME_START:
+  case Protocol::PacketType::PLAYER_INPUT:
+  case Protocol::PacketType::PLAYER_INPUT_EDGE:
+  case Protocol::PacketType::GAME_STATE_UPDATE:
+  case Protocol::PacketType::COIN_COLLECTED:
+  case Protocol::PacketType::PLAYER_DEATH:
+  case Protocol::PacketType::GAME_OVER:
+  case Protocol::PacketType::PLAYER_DISCONNECT:
+  case Protocol::PacketType::ENTITY_UPDATE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+size_t Jetpack::Shared::PacketCodec::getPacketSize(const uint8_t *data,
+                                                   size_t maxSize) {
+  if (maxSize < 1) {
+    return 0;
+  }
+
+  switch (static_cast<Protocol::PacketType>(data[0])) {
+  case Protocol::PacketType::CONNECT_RESPONSE:
+    return (maxSize >= 3) ? 3 : 0;
+
+  case Protocol::PacketType::MAP_DATA: {
+    if (maxSize < 5) {
+      return 0;
+    }
+    const int width = data[1] | (data[2] << 8);
+    const int height = data[3] | (data[4] << 8);
+    const size_t expectedSize = 5 + width * height;
+    return (maxSize >= expectedSize) ? expectedSize : 0;
+  }
+
+  case Protocol::PacketType::GAME_START:
+    return (maxSize >= 3) ? 3 : 0;
+
+  case Protocol::PacketType::GAME_STATE_UPDATE: {
+    if (maxSize < 2) {
+      return 0;
+    }
+    const size_t expectedSize =
+        GAME_STATE_HEADER_SIZE + data[1] * PLAYER_STATE_SIZE;
+    return (maxSize >= expectedSize) ? expectedSize : 0;
+  }
+
+  case Protocol::PacketType::COIN_COLLECTED:
+    return (maxSize >= 5) ? 5 : 0;
+
+  case Protocol::PacketType::PLAYER_DEATH:
+    return (maxSize >= 2) ? 2 : 0;
+
+  case Protocol::PacketType::GAME_OVER:
+    return (maxSize >= 3) ? 3 : 0;
+
+  case Protocol::PacketType::CONNECT_REQUEST:
+    return (maxSize >= 2) ? 2 : 0;
+
+  case Protocol::PacketType::PLAYER_INPUT:
+    return (maxSize >= PLAYER_INPUT_SIZE) ? PLAYER_INPUT_SIZE : 0;
+
+  case Protocol::PacketType::PLAYER_INPUT_EDGE:
+    return (maxSize >= PLAYER_INPUT_EDGE_SIZE) ? PLAYER_INPUT_EDGE_SIZE : 0;
+
+  case Protocol::PacketType::PLAYER_DISCONNECT:
+    return 1;
+
+  case Protocol::PacketType::ENTITY_UPDATE: {
+    if (maxSize < Protocol::ENTITY_UPDATE_HEADER_SIZE) {
+      return 0;
+    }
+    const size_t entityCount = data[1] | (data[2] << 8);
+    const size_t expectedSize = Protocol::ENTITY_UPDATE_HEADER_SIZE +
+                                entityCount * Protocol::ENTITY_DATA_SIZE;
+    return (maxSize >= expectedSize) ? expectedSize : 0;
+  }
+
+  default:
+    return 0;
+  }
+}
+
+bool Jetpack::Shared::PacketCodec::decodeGameStateUpdate(
+    const uint8_t *data, size_t length,
+    std::vector<Protocol::Player> &players, uint32_t *step) {
+  if (length < GAME_STATE_HEADER_SIZE) {
+    return false;
+  }
+
+  const int playerCount = data[1];
+  if (length < GAME_STATE_HEADER_SIZE + playerCount * PLAYER_STATE_SIZE) {
+    return false;
+  }
+  if (step) {
+    *step = data[2] | (data[3] << 8) | (data[4] << 16) |
+            (static_cast<uint32_t>(data[5]) << 24);
+  }
+
+  for (int i = 0; i < playerCount; i++) {
+    const size_t offset = GAME_STATE_HEADER_SIZE + i * PLAYER_STATE_SIZE;
+    const int playerId = data[offset];
+    const auto state = static_cast<Protocol::PlayerState>(data[offset + 1]);
+
+    const int16_t xFixedPrecision = data[offset + 2] | (data[offset + 3] << 8);
+    const int16_t yFixedPrecision = data[offset + 4] | (data[offset + 5] << 8);
+    const float x = xFixedPrecision / 100.0f;
+    const float y = yFixedPrecision / 100.0f;
+
+    const int score = data[offset + 6] | (data[offset + 7] << 8);
+    const bool isJetpacking = data[offset + 8] != 0;
+    const float velocityY =
+        decodeVelocity(static_cast<int8_t>(data[offset + 9]));
+    const uint16_t inputSequence = data[offset + 10] | (data[offset + 11] << 8);
+
+    Protocol::Player *player = nullptr;
+    for (auto &candidate : players) {
+      if (candidate.getId() == playerId) {
+        player = &candidate;
+        break;
+      }
+    }
+    if (!player) {
+      player = &players.emplace_back(-1, playerId);
+    }
+
+    player->setState(state);
+    player->setPosition(x, y);
+    player->setScore(score);
+    player->setJetpacking(isJetpacking);
+    player->setVelocityY(velocityY);
+    player->setInputSequence(inputSequence);
+  }
+
+  return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Physics.hpp"
+#include "Protocol.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Jetpack::Shared {
+class PacketCodec {
+public:
+  static constexpr size_t PLAYER_STATE_SIZE = 12;
+  static constexpr size_t PLAYER_INPUT_SIZE = 4;
+  static constexpr size_t PLAYER_INPUT_EDGE_SIZE = 8;
+  // Packet type, player count and the step the snapshot was taken at.
+  static constexpr size_t GAME_STATE_HEADER_SIZE = 6;
+  static constexpr float VELOCITY_SCALE = 127.0f / Physics::MAX_VELOCITY;
+  // getPacketSize() reads no further than this into data, whatever
+  // maxSize is.
+  static constexpr size_t MAX_HEADER_SIZE = 5;
+
+  // Vertical velocity travels as one signed byte spanning the physics
+  // clamp, which is enough for clients to replay the physics from it.
+  static int8_t encodeVelocity(float velocity) {
+    return static_cast<int8_t>(std::lround(velocity * VELOCITY_SCALE));
+  }
+  static float decodeVelocity(int8_t velocity) {
+    return velocity / VELOCITY_SCALE;
+  }
+
+  // Whether getPacketSize() can frame packets of this type.
+  static bool isKnownPacketType(uint8_t type);
+
+  // Returns the size of the packet at the start of data, or 0 when it is
+  // incomplete or of an unknown type.
+  static size_t getPacketSize(const uint8_t *data, size_t maxSize);
+
+  // Whether a snapshot acknowledging acked covers the input numbered
+  // sequence, allowing for the 16-bit counter wrapping around.
+  static bool isSequenceAcked(uint16_t acked, uint16_t sequence) {
+    return static_cast<int16_t>(acked - sequence) >= 0;
+  }
+
+  // Applies a GAME_STATE_UPDATE to players, appending unknown player ids,
+  // and stores the server step it was taken at in step when given.
+  static bool decodeGameStateUpdate(const uint8_t *data, size_t length,
+                                    std::vector<Protocol::Player> &players,
+                                    uint32_t *step = nullptr);
+};
+} // namespace Jetpack::Shared
@@ -0,0 +1,100 @@
+#include "PacketLogger.hpp"
+#include "Exceptions.hpp"
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+Jetpack::Shared::PacketLogger::PacketLogger(const std::string &path,
+                                            size_t capacity)
+    : m_file(path, std::ios::binary | std::ios::trunc),
+      m_capacity(std::bit_ceil(capacity)),
+      m_ring(std::make_unique<uint8_t[]>(m_capacity)) {
+  if (!m_file.is_open()) {
+    throw Exceptions::PacketLoggerException("Failed to open " + path);
+  }
+
+  m_file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+  m_writerThread = std::thread(&PacketLogger::writerLoop, this);
+}
+
+Jetpack::Shared::PacketLogger::~PacketLogger() {
+  m_running = false;
+  if (m_writerThread.joinable()) {
+    m_writerThread.join();
+  }
+
+  if (getDroppedCount() > 0) {
+    std::cerr << "Packet logger dropped " << getDroppedCount()
+              << " packets (ring buffer full)" << std::endl;
+  }
+}
+
+void Jetpack::Shared::PacketLogger::record(Direction direction, int socket,
+                                           const uint8_t *data,
+                                           size_t length) noexcept {
+  if (!isEnabled()) {
+    return;
+  }
+
+  const size_t recordSize = sizeof(RecordHeader) + length;
+  const uint64_t head = m_head.load(std::memory_order_relaxed);
+  const uint64_t tail = m_tail.load(std::memory_order_acquire);
+
+  if (recordSize > m_capacity - (head - tail)) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  RecordHeader header;
+  header.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+  header.socket = socket;
+  header.length = static_cast<uint32_t>(length);
+  header.direction = direction;
+
+  writeRing(head, &header, sizeof(header));
+  writeRing(head + sizeof(header), data, length);
+  m_head.store(head + recordSize, std::memory_order_release);
+}
+
+void Jetpack::Shared::PacketLogger::writeRing(uint64_t position,
+                                              const void *data,
+                                              size_t length) noexcept {
+  const size_t offset = position & (m_capacity - 1);
+  const size_t firstPart = std::min(length, m_capacity - offset);
+
+  std::memcpy(m_ring.get() + offset, data, firstPart);
+  std::memcpy(m_ring.get(), static_cast<const uint8_t *>(data) + firstPart,
+              length - firstPart);
+}
+
+void Jetpack::Shared::PacketLogger::writerLoop() {
+  while (m_running) {
+    drain();
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+  }
+  drain();
+}
+
+void Jetpack::Shared::PacketLogger::drain() {
+  const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+  const uint64_t head = m_head.load(std::memory_order_acquire);
+  if (head == tail) {
+    return;
+  }
+
+  const size_t offset = tail & (m_capacity - 1);
+  const size_t length = head - tail;
+  const size_t firstPart = std::min(length, m_capacity - offset);
+
+  m_file.write(reinterpret_cast<const char *>(m_ring.get() + offset),
+               firstPart);
+  m_file.write(reinterpret_cast<const char *>(m_ring.get()),
+               length - firstPart);
+  m_file.flush();
+
+  m_tail.store(head, std::memory_order_release);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace Jetpack::Shared {
+// Records raw packets into a lock-free single-producer ring buffer; a
+// background thread drains it into a binary log file. Only one thread may
+// call record() at a time.
+class PacketLogger {
+public:
+  enum class Direction : uint8_t { INCOMING = 0, OUTGOING = 1 };
+
+  struct RecordHeader {
+    uint64_t timestampNs = 0;
+    int32_t socket = -1;
+    uint32_t length = 0;
+    Direction direction = Direction::INCOMING;
+    uint8_t reserved[7] = {};
+  };
+
+  static constexpr char FILE_MAGIC[8] = {'J', 'P', 'K', 'L', 'O', 'G', '1', 0};
+
+  explicit PacketLogger(const std::string &path,
+                        size_t capacity = DEFAULT_CAPACITY);
+  ~PacketLogger();
+
+  PacketLogger(const PacketLogger &) = delete;
+  PacketLogger &operator=(const PacketLogger &) = delete;
+
+  void record(Direction direction, int socket, const uint8_t *data,
+              size_t length) noexcept;
+
+  void setEnabled(bool enabled) {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+  }
+  bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  uint64_t getDroppedCount() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+  static constexpr int DRAIN_INTERVAL_MS = 5;
+
+  void writeRing(uint64_t position, const void *data, size_t length) noexcept;
+  void writerLoop();
+  void drain();
+
+  std::ofstream m_file;
+
+  size_t m_capacity;
+  std::unique_ptr<uint8_t[]> m_ring;
+
+  alignas(64) std::atomic<uint64_t> m_head{0};
+  alignas(64) std::atomic<uint64_t> m_tail{0};
+  alignas(64) std::atomic<uint64_t> m_dropped{0};
+
+  std::atomic<bool> m_enabled{true};
+  std::atomic<bool> m_running{true};
+  std::thread m_writerThread;
+};
+} // namespace Jetpack::Shared
@@ -1,7 +1,7 @@
 #include "Physics.hpp"
 #include <algorithm>
 
-void Jetpack::Server::Physics::applyPhysics(Shared::Protocol::Player &player) {
+void Jetpack::Shared::Physics::applyPhysics(Protocol::Player &player) {
   player.setVelocityY(player.getVelocityY() + GRAVITY);
 
   if (player.isJetpacking()) {
@@ -15,8 +15,8 @@ void Jetpack::Server::Physics::applyPhysics(Shared::Protocol::Player &player) {
                      player.getPosition().y + player.getVelocityY());
 }
 
-void Jetpack::Server::Physics::checkBounds(
-    Shared::Protocol::Player &player, const Shared::Protocol::GameMap &map) {
+void Jetpack::Shared::Physics::checkBounds(Protocol::Player &player,
+                                           const Protocol::GameMap &map) {
   if (player.getPosition().y < 0) {
     player.setPosition(player.getPosition().x, 0);
     player.setVelocityY(0);
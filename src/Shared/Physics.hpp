@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Protocol.hpp"
+
+namespace Jetpack::Shared {
+// One simulation step of player movement, run by the server and replayed
+// by clients to predict their own player.
+class Physics {
+public:
+  static constexpr float MAX_VELOCITY = 0.05f;
+
+  static void applyPhysics(Protocol::Player &player);
+  static void checkBounds(Protocol::Player &player,
+                          const Protocol::GameMap &map);
+
+private:
+  static constexpr float GRAVITY = 0.008f;
+  static constexpr float JETPACK_FORCE = 0.013f;
+  static constexpr float HORIZONTAL_SPEED = 0.05f;
+};
+} // namespace Jetpack::Shared
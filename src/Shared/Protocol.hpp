@@ -1,16 +1,24 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <memory_resource>
 #include <vector>
 
 namespace Jetpack::Shared::Protocol {
+// Wall-clock length of one server simulation step.
+constexpr std::chrono::milliseconds TICK_PERIOD{16};
+
 enum class TileType { EMPTY, COIN, ELECTRICSQUARE };
 
 struct GameMap {
+  GameMap() = default;
+  explicit GameMap(std::pmr::memory_resource *resource) : tiles(resource) {}
+
   int width = 0;
   int height = 0;
-  std::vector<std::vector<TileType>> tiles;
+  std::pmr::vector<std::pmr::vector<TileType>> tiles;
 };
 
 struct Position {
@@ -37,6 +45,7 @@ private:
   bool m_isJetpacking = false;
 
   int m_Score = 0;
+  uint16_t m_inputSequence = 0;
 
   PlayerState m_state = PlayerState::CONNECTED;
 
@@ -50,12 +59,14 @@ public:
   float getVelocityY() const { return m_velocityY; }
   bool isJetpacking() const { return m_isJetpacking; }
   int getScore() const { return m_Score; }
+  uint16_t getInputSequence() const { return m_inputSequence; }
   PlayerState getState() const { return m_state; }
 
   void setPosition(float x, float y) { m_position = {x, y}; }
   void setVelocityY(float velocity) { m_velocityY = velocity; }
   void setJetpacking(bool jetpacking) { m_isJetpacking = jetpacking; }
   void setScore(int score) { m_Score = score; }
+  void setInputSequence(uint16_t sequence) { m_inputSequence = sequence; }
   void setState(PlayerState state) { m_state = state; }
 };
 
@@ -71,8 +82,38 @@ enum class PacketType : uint8_t {
   PLAYER_DEATH = 0x09,
   GAME_OVER = 0x0A,
   PLAYER_DISCONNECT = 0x0B,
+  ENTITY_UPDATE = 0x0C,
+  PLAYER_INPUT_EDGE = 0x0D,
+};
+
+enum class EntityType : uint8_t {
+  ZAPPER = 0x00,
+  MISSILE = 0x01,
+  LASER = 0x02,
 };
 
+struct EntityState {
+  int id = -1;
+  EntityType type = EntityType::ZAPPER;
+  bool active = false;
+  Position position;
+};
+
+constexpr size_t ENTITY_UPDATE_HEADER_SIZE = 3;
+constexpr size_t ENTITY_DATA_SIZE = 9;
+
+constexpr Position getEntityHalfExtent(EntityType type) {
+  switch (type) {
+  case EntityType::ZAPPER:
+    return {0.3f, 0.8f};
+  case EntityType::MISSILE:
+    return {0.4f, 0.25f};
+  case EntityType::LASER:
+    return {3.0f, 0.2f};
+  }
+  return {0.0f, 0.0f};
+}
+
 enum class GameState {
   WAITING_FOR_PLAYERS,
   IN_PROGRESS,
@@ -0,0 +1,241 @@
+#include "Trace.hpp"
+#include "Exceptions.hpp"
+#include <array>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<bool> Jetpack::Shared::Trace::s_enabled{false};
+
+namespace {
+struct TraceEvent {
+  const char *name;
+  uint64_t startUs;
+  uint64_t durationUs;
+};
+
+struct ThreadBuffer {
+  static constexpr size_t CAPACITY = 16 * 1024;
+
+  std::array<TraceEvent, CAPACITY> events;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  std::atomic<uint64_t> dropped{0};
+
+  long threadId = 0;
+  const char *threadName = nullptr;
+  bool threadNameWritten = false;
+};
+
+class TraceWriter {
+public:
+  void start(const std::string &path, const std::string &processName) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file.is_open()) {
+      throw Jetpack::Shared::Exceptions::TraceException(
+          "Tracing already started");
+    }
+
+    m_file.open(path, std::ios::trunc);
+    if (!m_file.is_open()) {
+      throw Jetpack::Shared::Exceptions::TraceException("Failed to open " +
+                                                        path);
+    }
+
+    // Tracing can be restarted at runtime; name threads again in the new file.
+    for (const auto &buffer : m_buffers) {
+      buffer->threadNameWritten = false;
+    }
+
+    m_pid = getpid();
+    m_file << "{\"traceEvents\":[\n"
+           << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << m_pid
+           << ",\"tid\":0,\"args\":{\"name\":\"" << processName << "\"}}";
+    m_file.flush();
+
+    m_running = true;
+    m_thread = std::thread(&TraceWriter::writerLoop, this);
+  }
+
+  void stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.is_open()) {
+      return;
+    }
+    drain();
+    m_file << "\n]}\n";
+    m_file.close();
+
+    uint64_t dropped = m_exitedDropped;
+    m_exitedDropped = 0;
+    for (const auto &buffer : m_buffers) {
+      dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    if (dropped > 0) {
+      std::cerr << "Trace dropped " << dropped
+                << " spans (thread buffer full)" << std::endl;
+    }
+  }
+
+  ThreadBuffer *registerThread(const char *name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.push_back(std::make_unique<ThreadBuffer>());
+    m_buffers.back()->threadId = syscall(SYS_gettid);
+    m_buffers.back()->threadName = name;
+    return m_buffers.back().get();
+  }
+
+  void setThreadName(ThreadBuffer *buffer, const char *name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->threadName = name;
+    buffer->threadNameWritten = false;
+  }
+
+  // Writes out what the exiting thread still holds and frees its buffer.
+  void unregisterThread(ThreadBuffer *buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file.is_open()) {
+      drain(*buffer);
+      m_file.flush();
+    }
+    m_exitedDropped += buffer->dropped.load(std::memory_order_relaxed);
+    std::erase_if(m_buffers, [buffer](const auto &entry) {
+      return entry.get() == buffer;
+    });
+  }
+
+private:
+  static constexpr int DRAIN_INTERVAL_MS = 10;
+
+  void writerLoop() {
+    while (m_running) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        drain();
+      }
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+    }
+  }
+
+  void drain() {
+    for (const auto &buffer : m_buffers) {
+      drain(*buffer);
+    }
+    m_file.flush();
+  }
+
+  void drain(ThreadBuffer &buffer) {
+    char line[256];
+
+    if (buffer.threadName && !buffer.threadNameWritten) {
+      auto result = std::format_to_n(
+          line, sizeof(line),
+          ",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},"
+          "\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+          m_pid, buffer.threadId, buffer.threadName);
+      m_file.write(line, result.out - line);
+      buffer.threadNameWritten = true;
+    }
+
+    const uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+    const uint64_t head = buffer.head.load(std::memory_order_acquire);
+    for (uint64_t i = tail; i < head; i++) {
+      const TraceEvent &event = buffer.events[i % ThreadBuffer::CAPACITY];
+      auto result = std::format_to_n(
+          line, sizeof(line),
+          ",\n{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{},\"dur\":{},"
+          "\"pid\":{},\"tid\":{}}}",
+          event.name, event.startUs, event.durationUs, m_pid,
+          buffer.threadId);
+      m_file.write(line, result.out - line);
+    }
+    buffer.tail.store(head, std::memory_order_release);
+  }
+
+  std::mutex m_mutex;
+  std::ofstream m_file;
+  int m_pid = 0;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+  uint64_t m_exitedDropped = 0;
+
+  std::atomic<bool> m_running{false};
+  std::thread m_thread;
+};
+
+TraceWriter &getWriter() {
+  static TraceWriter writer;
+  return writer;
+}
+
+// The calling thread's buffer, freed when the thread exits.
+struct ThreadRegistration {
+  ThreadBuffer *buffer = nullptr;
+
+  ~ThreadRegistration() {
+    if (buffer) {
+      getWriter().unregisterThread(buffer);
+    }
+  }
+};
+
+thread_local ThreadRegistration registration;
+} // namespace
+
+void Jetpack::Shared::Trace::start(const std::string &path,
+                                   const std::string &processName) {
+  getWriter().start(path, processName);
+  s_enabled = true;
+}
+
+void Jetpack::Shared::Trace::stop() {
+  s_enabled = false;
+  getWriter().stop();
+}
+
+void Jetpack::Shared::Trace::setThreadName(const char *name) {
+  // Registered even while disabled so that a trace started later covers the
+  // thread.
+  if (registration.buffer) {
+    getWriter().setThreadName(registration.buffer, name);
+  } else {
+    registration.buffer = getWriter().registerThread(name);
+  }
+}
+
+uint64_t Jetpack::Shared::Trace::now() noexcept {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void Jetpack::Shared::Trace::record(const char *name, uint64_t startUs,
+                                    uint64_t endUs) noexcept {
+  ThreadBuffer *buffer = registration.buffer;
+  if (!buffer) {
+    return;
+  }
+  const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  const uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+
+  if (head - tail >= ThreadBuffer::CAPACITY) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer->events[head % ThreadBuffer::CAPACITY] = {name, startUs,
+                                                   endUs - startUs};
+  buffer->head.store(head + 1, std::memory_order_release);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#define JETPACK_TRACE_CONCAT_INNER(a, b) a##b
+#define JETPACK_TRACE_CONCAT(a, b) JETPACK_TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name)                                                      \
+  ::Jetpack::Shared::Trace::Scope JETPACK_TRACE_CONCAT(traceScope,            \
+                                                       __LINE__)(name)
+
+namespace Jetpack::Shared {
+// Records complete-duration spans into per-thread ring buffers and streams
+// them as Chrome trace-event JSON from a background thread. Timestamps come
+// from the system clock so that traces of the server and of clients running
+// on the same machine line up on one timeline. Span names must be string
+// literals. Only threads that called setThreadName() are traced: that call
+// allocates the thread's buffer, so recording a span never allocates.
+class Trace {
+public:
+  static void start(const std::string &path, const std::string &processName);
+  static void stop();
+
+  static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+  static void setThreadName(const char *name);
+
+  static uint64_t now() noexcept;
+  static void record(const char *name, uint64_t startUs,
+                     uint64_t endUs) noexcept;
+
+  class Scope {
+  public:
+    explicit Scope(const char *name)
+        : m_name(isEnabled() ? name : nullptr), m_start(m_name ? now() : 0) {}
+    ~Scope() {
+      if (m_name) {
+        record(m_name, m_start, now());
+      }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    const char *m_name;
+    uint64_t m_start;
+  };
+
+private:
+  static std::atomic<bool> s_enabled;
+};
+} // namespace Jetpack::Shared